@@ -0,0 +1,358 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <string>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+#include <thread>
+
+#include "vertex_format.hpp"
+
+// what is drawn each frame
+enum class Scene {
+	// copies of the triangle laid out on a grid, see instanceCount
+	Triangles,
+	// triangles whose positions are integrated by a compute shader every frame, see particleCount
+	Particles
+};
+
+// how captured frames are written to disk
+enum class CaptureFormat {
+	// the pixels exactly as read back, one file per frame
+	Raw,
+	Ppm,
+	// uncompressed PNG, one file per frame
+	Png,
+	// every captured frame in one uncompressed YUV4MPEG2 stream
+	Video
+};
+
+struct AppConfig {
+	Scene scene = Scene::Triangles;
+	// render into offscreen images instead of a window, so no display or presentation support is needed
+	bool headless = false;
+	// number of frames to render before exiting, 0 renders until the window is closed (or HEADLESS_DEFAULT_FRAME_COUNT when headless)
+	uint64_t frameCount = 0;
+	// number of copies of the triangle drawn each frame, each with its own entry in the instance buffer
+	uint32_t instanceCount = 1;
+	// draw each copy with its own draw call instead of one instanced draw, for comparing the two
+	bool individualDraws = false;
+	// number of particles simulated and drawn by the particle scene
+	uint32_t particleCount = 1000000;
+	// cull instances against the view in a compute shader and draw the survivors with indirect draws
+	bool gpuCulling = false;
+	// magnification of the view, values above 1 show part of the instance grid and pan across it so culling has work to do
+	float viewZoom = 1.0f;
+	// threads recording each frame's draws into secondary command buffers, 1 records them inline in the primary command buffer
+	uint32_t recordThreads = 1;
+	// number of frames the CPU may record and submit ahead of the GPU
+	uint32_t framesInFlight = 2;
+	// preferred present mode, FIFO is used if the surface does not support it
+	VkPresentModeKHR presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+	// number of swapchain (or offscreen) images, 0 uses one more than the surface minimum (or than frames in flight when headless)
+	uint32_t swapchainImageCount = 0;
+	// wait for the previous frame to be presented before sampling input for the next, trading throughput for latency
+	bool lowLatency = false;
+	// file the pipeline cache is loaded from at startup and written back to at exit, empty to compile pipelines without a cache
+	std::string pipelineCachePath = "pipeline_cache.bin";
+	// run independent initialisation steps on worker threads rather than one after another
+	bool parallelInit = true;
+	// mesh file written by MeshConverter, drawn in place of the triangle, empty for the triangle
+	std::string meshPath;
+	// write the triangle's vertices into the streaming ring every frame instead of drawing the static device local copy
+	bool streamedGeometry = false;
+	// layout the mesh (or triangle) is converted to when it is uploaded, compressed formats halve the bytes fetched per vertex
+	VertexFormat vertexFormat = VertexFormat::Float;
+	// copy every Nth rendered frame to disk from a background thread, 0 disables capture
+	uint32_t captureEvery = 0;
+	CaptureFormat captureFormat = CaptureFormat::Ppm;
+	// directory captured frames are written to, created if missing
+	std::string captureDirectory = "capture";
+	// recompile shaders/shader.vert and shader.frag when they change and swap the new pipeline in without stopping
+	bool hotReload = false;
+	// number of groups the instances are split into, each drawn with its own graphics pipeline variant built in the background, at most 8
+	uint32_t pipelineVariants = 1;
+	// allocate and write a descriptor set for every draw instead of binding one shared set at a dynamic offset, for comparing the two
+	bool perDrawDescriptorSets = false;
+	// directory to load .spv files from instead of the shaders embedded in the binary, for trying shaders without rebuilding
+	std::string shaderDirectory;
+	// index, UUID or part of the name of the device to run on, empty to pick the highest scoring one
+	std::string deviceSelector;
+	// print every device with its score and whether it can run the app, then exit without rendering
+	bool listDevices = false;
+	// MiB copied into a device local buffer every frame alongside rendering, 0 disables uploads
+	uint32_t uploadMiB = 0;
+	// submit uploads to a transfer only queue when the device has one, rather than to the graphics queue
+	bool transferQueue = true;
+	// print throughput and frame statistics on exit
+	bool printReport = true;
+};
+
+inline VkPresentModeKHR parsePresentMode(const std::string& name) {
+	if (name == "immediate") {
+		return VK_PRESENT_MODE_IMMEDIATE_KHR;
+	}
+	else if (name == "mailbox") {
+		return VK_PRESENT_MODE_MAILBOX_KHR;
+	}
+	else if (name == "fifo") {
+		return VK_PRESENT_MODE_FIFO_KHR;
+	}
+	else if (name == "fifo_relaxed") {
+		return VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+	}
+
+	throw std::runtime_error("ERROR: Unrecognised present mode " + name);
+}
+
+inline std::string presentModeName(VkPresentModeKHR presentMode) {
+	switch (presentMode) {
+		case VK_PRESENT_MODE_IMMEDIATE_KHR:
+			return "immediate";
+		case VK_PRESENT_MODE_MAILBOX_KHR:
+			return "mailbox";
+		case VK_PRESENT_MODE_FIFO_KHR:
+			return "fifo";
+		case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+			return "fifo_relaxed";
+		default:
+			return "unknown";
+	}
+}
+
+inline Scene parseScene(const std::string& name) {
+	if (name == "triangles") {
+		return Scene::Triangles;
+	}
+	else if (name == "particles") {
+		return Scene::Particles;
+	}
+
+	throw std::runtime_error("ERROR: Unrecognised scene " + name);
+}
+
+inline std::string sceneName(Scene scene) {
+	switch (scene) {
+		case Scene::Triangles:
+			return "triangles";
+		case Scene::Particles:
+			return "particles";
+		default:
+			return "unknown";
+	}
+}
+
+inline CaptureFormat parseCaptureFormat(const std::string& name) {
+	if (name == "raw") {
+		return CaptureFormat::Raw;
+	}
+	else if (name == "ppm") {
+		return CaptureFormat::Ppm;
+	}
+	else if (name == "png") {
+		return CaptureFormat::Png;
+	}
+	else if (name == "video") {
+		return CaptureFormat::Video;
+	}
+
+	throw std::runtime_error("ERROR: Unrecognised capture format " + name);
+}
+
+inline std::string captureFormatName(CaptureFormat format) {
+	switch (format) {
+		case CaptureFormat::Raw:
+			return "raw";
+		case CaptureFormat::Ppm:
+			return "ppm";
+		case CaptureFormat::Png:
+			return "png";
+		case CaptureFormat::Video:
+			return "video";
+		default:
+			return "unknown";
+	}
+}
+
+inline VertexFormat parseVertexFormat(const std::string& name) {
+	if (name == "float") {
+		return VertexFormat::Float;
+	}
+	else if (name == "snorm16") {
+		return VertexFormat::Snorm16;
+	}
+	else if (name == "half") {
+		return VertexFormat::Half;
+	}
+
+	throw std::runtime_error("ERROR: Unrecognised vertex format " + name);
+}
+
+inline std::string vertexFormatName(VertexFormat format) {
+	switch (format) {
+		case VertexFormat::Float:
+			return "float";
+		case VertexFormat::Snorm16:
+			return "snorm16";
+		case VertexFormat::Half:
+			return "half";
+		default:
+			return "unknown";
+	}
+}
+
+// overrides the fields of config given on the command line, so callers can choose their own defaults
+inline void parseArguments(int argc, char* argv[], AppConfig& config) {
+	// the environment picks the device for every run, --device overrides it for one
+	const char* deviceSelector = std::getenv("VT_DEVICE");
+	if (deviceSelector != nullptr) {
+		config.deviceSelector = deviceSelector;
+	}
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "--headless") {
+			config.headless = true;
+		}
+		else if (arg == "--windowed") {
+			config.headless = false;
+		}
+		else if (arg == "--frames" && hasValue) {
+			config.frameCount = std::stoull(argv[++i]);
+		}
+		else if ((arg == "--instances" || arg == "--triangles") && hasValue) {
+			config.instanceCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (arg == "--mesh" && hasValue) {
+			config.meshPath = argv[++i];
+		}
+		else if (arg == "--vertex-format" && hasValue) {
+			config.vertexFormat = parseVertexFormat(argv[++i]);
+		}
+		else if (arg == "--scene" && hasValue) {
+			config.scene = parseScene(argv[++i]);
+		}
+		else if (arg == "--particles" && hasValue) {
+			config.particleCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (arg == "--frames-in-flight" && hasValue) {
+			config.framesInFlight = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (arg == "--present-mode" && hasValue) {
+			config.presentMode = parsePresentMode(argv[++i]);
+		}
+		else if (arg == "--swapchain-images" && hasValue) {
+			config.swapchainImageCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (arg == "--low-latency") {
+			config.lowLatency = true;
+		}
+		else if (arg == "--capture-every" && hasValue) {
+			config.captureEvery = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (arg == "--capture-format" && hasValue) {
+			config.captureFormat = parseCaptureFormat(argv[++i]);
+			// choosing a format without a rate captures every frame
+			if (config.captureEvery == 0) {
+				config.captureEvery = 1;
+			}
+		}
+		else if (arg == "--capture-path" && hasValue) {
+			config.captureDirectory = argv[++i];
+		}
+		else if (arg == "--shader-dir" && hasValue) {
+			config.shaderDirectory = argv[++i];
+		}
+		else if (arg == "--pipeline-variants" && hasValue) {
+			config.pipelineVariants = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (arg == "--device" && hasValue) {
+			config.deviceSelector = argv[++i];
+		}
+		else if (arg == "--list-devices") {
+			config.listDevices = true;
+		}
+		else if (arg == "--upload-mib" && hasValue) {
+			config.uploadMiB = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (arg == "--no-transfer-queue") {
+			config.transferQueue = false;
+		}
+		else if (arg == "--per-draw-descriptor-sets") {
+			config.perDrawDescriptorSets = true;
+		}
+		else if (arg == "--hot-reload") {
+			config.hotReload = true;
+		}
+		else if (arg == "--pipeline-cache" && hasValue) {
+			config.pipelineCachePath = argv[++i];
+		}
+		else if (arg == "--serial-init") {
+			config.parallelInit = false;
+		}
+		else if (arg == "--no-pipeline-cache") {
+			config.pipelineCachePath.clear();
+		}
+		else if (arg == "--streamed-geometry") {
+			config.streamedGeometry = true;
+		}
+		else if (arg == "--individual-draws") {
+			config.individualDraws = true;
+		}
+		else if (arg == "--gpu-culling") {
+			config.gpuCulling = true;
+		}
+		else if (arg == "--view-zoom" && hasValue) {
+			config.viewZoom = std::stof(argv[++i]);
+		}
+		else if (arg == "--record-threads" && hasValue) {
+			std::string value = argv[++i];
+			// "auto" uses one recording thread per hardware thread
+			config.recordThreads = value == "auto" ? std::max(1u, std::thread::hardware_concurrency()) : static_cast<uint32_t>(std::stoul(value));
+		}
+		else {
+			throw std::runtime_error("ERROR: Unrecognised argument " + arg);
+		}
+	}
+
+	if (config.instanceCount == 0 || config.particleCount == 0 || config.framesInFlight == 0 || config.recordThreads == 0) {
+		throw std::runtime_error("ERROR: Instance count, particle count, frames in flight and record threads must be at least 1");
+	}
+
+	if (config.pipelineVariants == 0 || config.pipelineVariants > 8) {
+		throw std::runtime_error("ERROR: Pipeline variants must be between 1 and 8");
+	}
+
+	// variants are built from the shaders loaded at startup and drawn through the render queue, which culled draws bypass
+	if (config.pipelineVariants > 1 && (config.hotReload || config.gpuCulling)) {
+		throw std::runtime_error("ERROR: Pipeline variants are not supported with --hot-reload or --gpu-culling");
+	}
+
+	// culled draws are a single indirect draw with one set of uniforms, so there are no draws to give sets of their own
+	if (config.perDrawDescriptorSets && config.gpuCulling) {
+		throw std::runtime_error("ERROR: Per draw descriptor sets are not supported with --gpu-culling");
+	}
+
+	if (config.scene == Scene::Particles && config.gpuCulling) {
+		throw std::runtime_error("ERROR: GPU culling is not supported by the particle scene");
+	}
+
+	// streaming rewrites the vertices on the CPU every frame, and a mapped mesh is never held there
+	if (!config.meshPath.empty() && config.streamedGeometry) {
+		throw std::runtime_error("ERROR: Streamed geometry is not supported with --mesh");
+	}
+
+	// streamed vertices are written as they are, the packed formats are only produced at upload
+	if (config.vertexFormat != VertexFormat::Float && config.streamedGeometry) {
+		throw std::runtime_error("ERROR: Streamed geometry only supports the float vertex format");
+	}
+
+	if (config.viewZoom <= 0.0f) {
+		throw std::runtime_error("ERROR: View zoom must be greater than 0");
+	}
+}
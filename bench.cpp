@@ -0,0 +1,126 @@
+#include "vulkan_triangle_application.hpp"
+
+#include <sstream>
+
+// benchmark driver, runs a single scenario and prints its results as one line of JSON so runs can be appended to a file and compared between builds
+
+static std::string jsonString(const std::string& value) {
+	std::string escaped = "\"";
+	for (char c : value) {
+		if (c == '"' || c == '\\') {
+			escaped += '\\';
+		}
+		escaped += c;
+	}
+	return escaped + "\"";
+}
+
+static std::string jsonPercentiles(const PercentileSummary& percentiles) {
+	std::ostringstream json;
+	json << "{\"count\": " << percentiles.count << ", \"p50\": " << percentiles.p50 << ", \"p95\": " << percentiles.p95 << ", \"p99\": " << percentiles.p99 << "}";
+	return json.str();
+}
+
+int main(int argc, char* argv[]) {
+	try {
+		// benchmarks default to a fixed number of headless frames so results do not depend on a window or display
+		AppConfig config;
+		config.headless = true;
+		config.frameCount = 1000;
+		config.printReport = false;
+		parseArguments(argc, argv, config);
+
+		VulkanTriangleApplication app(config);
+
+		app.run();
+
+		// listing devices renders nothing, so there is nothing to report
+		if (config.listDevices) {
+			return EXIT_SUCCESS;
+		}
+
+		const RunStatistics& runStatistics = app.getRunStatistics();
+		GpuProfilerSummary summary = app.getProfilerSummary();
+
+		std::ostringstream json;
+		json << "{";
+		json << "\"scenario\": {\"headless\": " << (config.headless ? "true" : "false") << ", \"frames\": " << config.frameCount << ", \"scene\": " << jsonString(sceneName(config.scene)) << ", \"instances\": " << config.instanceCount << ", \"individualDraws\": " << (config.individualDraws ? "true" : "false") << ", \"recordThreads\": " << config.recordThreads << ", \"gpuCulling\": " << (config.gpuCulling ? "true" : "false") << ", \"viewZoom\": " << config.viewZoom << ", \"framesInFlight\": " << config.framesInFlight << ", \"presentMode\": " << jsonString(presentModeName(config.presentMode)) << ", \"swapchainImages\": " << config.swapchainImageCount << ", \"lowLatency\": " << (config.lowLatency ? "true" : "false") << ", \"parallelInit\": " << (config.parallelInit ? "true" : "false") << ", \"streamedGeometry\": " << (config.streamedGeometry ? "true" : "false") << ", \"vertexFormat\": " << jsonString(vertexFormatName(config.vertexFormat)) << ", \"captureEvery\": " << config.captureEvery << ", \"captureFormat\": " << jsonString(captureFormatName(config.captureFormat)) << "}, ";
+		// the UUID identifies the device exactly, so runs on different machines or devices are never compared by mistake
+		const DeviceCandidate& device = app.getSelectedDevice();
+		json << "\"device\": " << jsonString(app.getDeviceName()) << ", \"deviceType\": " << jsonString(deviceTypeName(device.type)) << ", \"deviceUuid\": " << jsonString(device.uuid) << ", \"deviceScore\": " << device.score.total() << ", ";
+
+		// steps may overlap, so the total is when the last one finished rather than the sum of their durations
+		double initTotal = 0.0;
+		json << "\"initMs\": {";
+		for (const auto& timing : app.getInitTimings()) {
+			json << jsonString(timing.name) << ": {\"start\": " << timing.startMs << ", \"duration\": " << timing.durationMs << "}, ";
+			initTotal = std::max(initTotal, timing.startMs + timing.durationMs);
+		}
+		json << "\"total\": " << initTotal << "}, ";
+		json << "\"timeToFirstFrameMs\": " << runStatistics.timeToFirstFrameMs << ", ";
+
+		double framesPerSecond = runStatistics.elapsedSeconds > 0.0 ? runStatistics.framesRendered / runStatistics.elapsedSeconds : 0.0;
+		const PipelineCacheStats& cacheStats = app.getPipelineCacheStats();
+		json << "\"pipelineCache\": {\"enabled\": " << (cacheStats.enabled ? "true" : "false") << ", \"hit\": " << (cacheStats.hit ? "true" : "false") << ", \"compileMs\": " << cacheStats.compileMs << ", \"savedMs\": " << cacheStats.savedMs() << "}, ";
+
+		const GpuAllocatorStats& memoryStats = app.getMemoryStats();
+		json << "\"memory\": {\"bytesUsed\": " << memoryStats.bytesUsed << ", \"bytesReserved\": " << memoryStats.bytesReserved << ", \"blocks\": " << memoryStats.blockCount << ", \"allocations\": " << memoryStats.allocationCount << ", \"fragmentation\": " << memoryStats.fragmentation << ", \"nearBudget\": " << (memoryStats.nearBudget ? "true" : "false") << "}, ";
+
+		// vertex throughput is compared between runs with different --vertex-format values
+		const GeometryStats& geometryStats = app.getGeometryStats();
+		json << "\"geometry\": {\"bytesPerVertex\": " << geometryStats.bytesPerVertex << ", \"bytesPerIndex\": " << geometryStats.bytesPerIndex << ", \"bytes\": " << geometryStats.bytes() << ", \"fullFloatBytes\": " << geometryStats.fullFloatBytes() << ", \"verticesPerGpuSecond\": " << app.getVertexThroughput() << ", \"vertexBytesPerGpuSecond\": " << app.getVertexThroughput() * geometryStats.bytesPerVertex << "}, ";
+
+		json << "\"framesRendered\": " << runStatistics.framesRendered << ", \"seconds\": " << runStatistics.elapsedSeconds << ", \"framesPerSecond\": " << framesPerSecond << ", ";
+		json << "\"cpuFrameMs\": " << jsonPercentiles(summary.cpuFrameTimeMs) << ", ";
+		json << "\"cpuWaitMs\": " << jsonPercentiles(summary.cpuWaitMs) << ", ";
+		json << "\"cpuRecordMs\": " << jsonPercentiles(summary.cpuRecordMs) << ", ";
+		json << "\"gpuFrameMs\": " << jsonPercentiles(summary.gpuTimeMs) << ", ";
+
+		LatencySummary latency = app.getLatencySummary();
+		json << "\"latency\": {\"images\": " << app.getSwapchainImageCount() << ", \"presentWait\": " << (app.isPresentWaitEnabled() ? "true" : "false") << ", \"inputToSubmitMs\": " << jsonPercentiles(latency.inputToSubmitMs) << ", \"submitToPresentMs\": " << jsonPercentiles(latency.submitToPresentMs) << ", \"inputToPresentMs\": " << jsonPercentiles(latency.inputToPresentMs) << ", \"droppedFrames\": " << latency.droppedFrames << "}";
+		const RenderBindCounts& binds = app.getRenderQueueBinds();
+		json << ", \"renderQueue\": {\"draws\": " << binds.draws << ", \"pipelineBinds\": " << binds.pipelineBinds << ", \"descriptorSetBinds\": " << binds.descriptorSetBinds << ", \"geometryBinds\": " << binds.geometryBinds << ", \"savedBinds\": " << binds.savedBinds() << ", \"sortMs\": " << jsonPercentiles(app.getRenderQueueSortMs()) << "}";
+		// compared between runs with and without --per-draw-descriptor-sets
+		DescriptorSummary descriptors = app.getDescriptorSummary();
+		json << ", \"descriptors\": {\"mode\": " << jsonString(descriptors.perDrawSets ? "per-draw" : "dynamic-offset") << ", \"setsAllocated\": " << descriptors.frame.setsAllocated << ", \"descriptorWrites\": " << descriptors.frame.descriptorWrites << ", \"tableResources\": " << descriptors.tableResources << ", \"tableCapacity\": " << descriptors.tableCapacity << ", \"updateMs\": " << jsonPercentiles(descriptors.updateMs) << "}";
+		if (config.pipelineVariants > 1) {
+			const PipelineVariantSummary& variants = app.getPipelineVariantSummary();
+			json << ", \"pipelineVariants\": {\"requested\": " << config.pipelineVariants << ", \"built\": " << variants.variants << ", \"failures\": " << variants.failures << ", \"queueDepth\": " << variants.queueDepth << ", \"maxQueueDepth\": " << variants.maxQueueDepth << ", \"requests\": " << variants.requests << ", \"hitRate\": " << variants.hitRate() << ", \"compileMs\": " << jsonPercentiles(variants.compileMs) << "}";
+		}
+		// compared between runs with and without --no-transfer-queue, along with the frame times above
+		if (config.uploadMiB > 0) {
+			UploadSummary uploads = app.getUploadSummary();
+			json << ", \"uploads\": {\"queue\": " << jsonString(uploads.dedicatedQueue ? "transfer" : "graphics") << ", \"mibPerFrame\": " << config.uploadMiB << ", \"batches\": " << uploads.batches << ", \"bytes\": " << uploads.bytes << ", \"droppedBytes\": " << uploads.refusedBytes << ", \"bytesPerSecond\": " << uploads.bytesPerSecond() << ", \"batchLatencyMs\": " << jsonPercentiles(uploads.batchLatencyMs) << "}";
+		}
+		if (config.gpuCulling) {
+			GpuCullingSummary cullingSummary = app.getCullingSummary();
+			json << ", \"drawnInstances\": " << jsonPercentiles(cullingSummary.drawnInstances) << ", \"culledInstances\": " << jsonPercentiles(cullingSummary.culledInstances);
+		}
+		if (!config.meshPath.empty()) {
+			const MeshLoadStats& meshStats = app.getMeshLoadStats();
+			json << ", \"mesh\": {\"path\": " << jsonString(config.meshPath) << ", \"vertices\": " << meshStats.vertexCount << ", \"indices\": " << meshStats.indexCount << ", \"bytes\": " << meshStats.bytes << ", \"loadMs\": " << meshStats.loadMs << ", \"bytesPerSecond\": " << meshStats.bytesPerSecond();
+			if (meshStats.imported) {
+				const MeshImportStats& import = meshStats.import;
+				const MeshOptimizationStats& optimization = meshStats.optimization;
+				json << ", \"import\": {\"threads\": " << import.threads << ", \"sourceVertices\": " << import.sourceVertices << ", \"parseMs\": " << import.parseMs << ", \"deduplicateMs\": " << import.deduplicateMs << ", \"optimizeMs\": " << optimization.optimizeMs << ", \"peakMemoryBytes\": " << import.peakMemoryBytes << ", \"acmrBefore\": " << optimization.before.acmr << ", \"acmrAfter\": " << optimization.after.acmr << ", \"atvrBefore\": " << optimization.before.atvr << ", \"atvrAfter\": " << optimization.after.atvr << "}";
+			}
+			json << "}";
+		}
+		if (config.captureEvery > 0) {
+			const FrameCaptureStats& captureStats = app.getCaptureStats();
+			json << ", \"capture\": {\"framesCaptured\": " << captureStats.framesCaptured << ", \"framesWritten\": " << captureStats.framesWritten << ", \"framesDropped\": " << captureStats.framesDropped << ", \"framesSkipped\": " << captureStats.framesSkipped << ", \"bytesWritten\": " << captureStats.bytesWritten << ", \"bytesPerSecond\": " << captureStats.bytesPerSecond() << "}";
+		}
+		if (config.scene == Scene::Particles) {
+			json << ", \"particles\": {\"count\": " << config.particleCount << ", \"simulationMs\": " << jsonPercentiles(summary.gpuComputeMs) << ", \"particlesPerSecond\": " << app.getParticleThroughput() << "}";
+		}
+		json << "}";
+
+		std::cout << json.str() << std::endl;
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <stdexcept>
+#include <cstdint>
+
+#include "frame_stats.hpp"
+
+// most resources the bindless table holds, devices with lower storage buffer limits get a smaller table
+const uint32_t DESCRIPTOR_TABLE_CAPACITY = 1024;
+
+// per draw values written into the uniform ring every frame, matches the Draw block in shader.vert
+struct DrawUniforms {
+	// index of the draw's material in the descriptor table
+	uint32_t material;
+	uint32_t padding[3];
+};
+
+// descriptor work done by the last frame, nothing is allocated or written per frame unless every draw gets its own set
+struct DescriptorFrameCounts {
+	uint64_t setsAllocated = 0;
+	uint64_t descriptorWrites = 0;
+};
+
+struct DescriptorSummary {
+	bool perDrawSets = false;
+	DescriptorFrameCounts frame;
+	uint32_t tableResources = 0;
+	uint32_t tableCapacity = 0;
+	// time spent writing a frame's uniforms and, for per draw sets, allocating and writing them
+	PercentileSummary updateMs;
+};
+
+// one large partially bound array of storage buffers, resources are registered into it once and shaders index it by integer
+// registering only happens before the set is first bound, as updating a set in use would need update after bind
+class DescriptorTable {
+	public:
+		void create(VkDevice logicalDevice, uint32_t tableCapacity, VkShaderStageFlags stages) {
+			device = logicalDevice;
+			capacity = tableCapacity;
+
+			VkDescriptorSetLayoutBinding binding{};
+			binding.binding = 0;
+			binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			binding.descriptorCount = capacity;
+			binding.stageFlags = stages;
+
+			// slots nothing has been registered in are never read, so they need no valid descriptor
+			VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+			VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsCreateInfo{};
+			bindingFlagsCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+			bindingFlagsCreateInfo.bindingCount = 1;
+			bindingFlagsCreateInfo.pBindingFlags = &bindingFlags;
+
+			VkDescriptorSetLayoutCreateInfo layoutCreateInfo{};
+			layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+			layoutCreateInfo.pNext = &bindingFlagsCreateInfo;
+			layoutCreateInfo.bindingCount = 1;
+			layoutCreateInfo.pBindings = &binding;
+
+			if (vkCreateDescriptorSetLayout(device, &layoutCreateInfo, nullptr, &layout) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to create descriptor table layout");
+			}
+
+			VkDescriptorPoolSize poolSize{};
+			poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			poolSize.descriptorCount = capacity;
+
+			VkDescriptorPoolCreateInfo poolCreateInfo{};
+			poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+			poolCreateInfo.maxSets = 1;
+			poolCreateInfo.poolSizeCount = 1;
+			poolCreateInfo.pPoolSizes = &poolSize;
+
+			if (vkCreateDescriptorPool(device, &poolCreateInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to create descriptor table pool");
+			}
+
+			VkDescriptorSetAllocateInfo setAllocateInfo{};
+			setAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			setAllocateInfo.descriptorPool = descriptorPool;
+			setAllocateInfo.descriptorSetCount = 1;
+			setAllocateInfo.pSetLayouts = &layout;
+
+			if (vkAllocateDescriptorSets(device, &setAllocateInfo, &descriptorSet) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to allocate descriptor table");
+			}
+		}
+
+		void destroy() {
+			if (device == VK_NULL_HANDLE) {
+				return;
+			}
+
+			vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+			vkDestroyDescriptorSetLayout(device, layout, nullptr);
+		}
+
+		// the index shaders read the buffer range through
+		uint32_t registerBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+			if (registered == capacity) {
+				throw std::runtime_error("ERROR: Descriptor table full");
+			}
+
+			VkDescriptorBufferInfo bufferInfo{buffer, offset, range};
+
+			VkWriteDescriptorSet descriptorWrite{};
+			descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrite.dstSet = descriptorSet;
+			descriptorWrite.dstBinding = 0;
+			descriptorWrite.dstArrayElement = registered;
+			descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			descriptorWrite.descriptorCount = 1;
+			descriptorWrite.pBufferInfo = &bufferInfo;
+
+			vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+
+			return registered++;
+		}
+
+		VkDescriptorSetLayout getLayout() const {
+			return layout;
+		}
+
+		VkDescriptorSet getSet() const {
+			return descriptorSet;
+		}
+
+		uint32_t getRegisteredCount() const {
+			return registered;
+		}
+
+		uint32_t getCapacity() const {
+			return capacity;
+		}
+
+	private:
+		VkDevice device = VK_NULL_HANDLE;
+		uint32_t capacity = 0;
+		uint32_t registered = 0;
+
+		VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+		VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+		VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+};
+
+// sets of a single dynamic uniform buffer binding pointing into the uniform ring
+// normally one set is written at startup and every draw selects its uniforms with a dynamic offset when it is bound
+// as a baseline, a set can instead be allocated and written for each draw from per frame pools, reset once their frame has finished
+class DrawDescriptorSets {
+	public:
+		static VkDescriptorSetLayout createDescriptorSetLayout(VkDevice logicalDevice) {
+			VkDescriptorSetLayoutBinding binding{};
+			binding.binding = 0;
+			binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+			binding.descriptorCount = 1;
+			binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+			VkDescriptorSetLayoutCreateInfo layoutCreateInfo{};
+			layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+			layoutCreateInfo.bindingCount = 1;
+			layoutCreateInfo.pBindings = &binding;
+
+			VkDescriptorSetLayout layout;
+			if (vkCreateDescriptorSetLayout(logicalDevice, &layoutCreateInfo, nullptr, &layout) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to create draw descriptor set layout");
+			}
+
+			return layout;
+		}
+
+		// setsPerFrame is the most sets any frame allocates, 0 when draws only use the shared set
+		void create(VkDevice logicalDevice, VkDescriptorSetLayout descriptorSetLayout, VkBuffer uniformBuffer, uint32_t slotCount, uint32_t setsPerFrame) {
+			device = logicalDevice;
+			layout = descriptorSetLayout;
+			uniforms = uniformBuffer;
+
+			sharedPool = createPool(1);
+			sharedSet = allocateSet(sharedPool);
+			writeSet(sharedSet, 0);
+
+			if (setsPerFrame > 0) {
+				for (uint32_t slot = 0; slot < slotCount; slot++) {
+					framePools.push_back(createPool(setsPerFrame));
+				}
+			}
+		}
+
+		void destroy() {
+			if (device == VK_NULL_HANDLE) {
+				return;
+			}
+
+			for (auto pool : framePools) {
+				vkDestroyDescriptorPool(device, pool, nullptr);
+			}
+			vkDestroyDescriptorPool(device, sharedPool, nullptr);
+		}
+
+		// called before recording the frame using slot, once the frame which last used it has finished
+		void beginFrame(uint32_t slot) {
+			currentSlot = slot;
+			counts = DescriptorFrameCounts();
+
+			if (!framePools.empty()) {
+				vkResetDescriptorPool(device, framePools[slot], 0);
+			}
+		}
+
+		// bound with a dynamic offset selecting the draw's uniforms
+		VkDescriptorSet getSharedSet() const {
+			return sharedSet;
+		}
+
+		// a set of its own pointing at the uniforms at offset, bound with a dynamic offset of 0
+		VkDescriptorSet allocatePerDraw(VkDeviceSize offset) {
+			VkDescriptorSet descriptorSet = allocateSet(framePools[currentSlot]);
+			writeSet(descriptorSet, offset);
+
+			return descriptorSet;
+		}
+
+		const DescriptorFrameCounts& getFrameCounts() const {
+			return counts;
+		}
+
+	private:
+		VkDevice device = VK_NULL_HANDLE;
+		VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+		VkBuffer uniforms = VK_NULL_HANDLE;
+
+		VkDescriptorPool sharedPool = VK_NULL_HANDLE;
+		VkDescriptorSet sharedSet = VK_NULL_HANDLE;
+		std::vector<VkDescriptorPool> framePools;
+		uint32_t currentSlot = 0;
+		DescriptorFrameCounts counts;
+
+		VkDescriptorPool createPool(uint32_t setCount) {
+			VkDescriptorPoolSize poolSize{};
+			poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+			poolSize.descriptorCount = setCount;
+
+			VkDescriptorPoolCreateInfo poolCreateInfo{};
+			poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+			poolCreateInfo.maxSets = setCount;
+			poolCreateInfo.poolSizeCount = 1;
+			poolCreateInfo.pPoolSizes = &poolSize;
+
+			VkDescriptorPool pool;
+			if (vkCreateDescriptorPool(device, &poolCreateInfo, nullptr, &pool) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to create draw descriptor pool");
+			}
+
+			return pool;
+		}
+
+		VkDescriptorSet allocateSet(VkDescriptorPool pool) {
+			VkDescriptorSetAllocateInfo setAllocateInfo{};
+			setAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			setAllocateInfo.descriptorPool = pool;
+			setAllocateInfo.descriptorSetCount = 1;
+			setAllocateInfo.pSetLayouts = &layout;
+
+			VkDescriptorSet descriptorSet;
+			if (vkAllocateDescriptorSets(device, &setAllocateInfo, &descriptorSet) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to allocate draw descriptor set");
+			}
+			counts.setsAllocated++;
+
+			return descriptorSet;
+		}
+
+		void writeSet(VkDescriptorSet descriptorSet, VkDeviceSize offset) {
+			VkDescriptorBufferInfo bufferInfo{uniforms, offset, sizeof(DrawUniforms)};
+
+			VkWriteDescriptorSet descriptorWrite{};
+			descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrite.dstSet = descriptorSet;
+			descriptorWrite.dstBinding = 0;
+			descriptorWrite.dstArrayElement = 0;
+			descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+			descriptorWrite.descriptorCount = 1;
+			descriptorWrite.pBufferInfo = &bufferInfo;
+
+			vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+			counts.descriptorWrites++;
+		}
+};
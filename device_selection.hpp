@@ -0,0 +1,206 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <cstdio>
+#include <cctype>
+#include <cstdint>
+#include <algorithm>
+
+// a device's score is its type's weight plus points for its memory, limits, queues and features
+// the other points never add up to a type weight, so a better type of device always wins and the rest only breaks ties between devices of the same type
+const uint32_t DEVICE_SCORE_TYPE_WEIGHT = 1000;
+
+struct DeviceScore {
+	uint32_t type = 0;
+	// per GiB of device local memory, up to 64 GiB
+	uint32_t memory = 0;
+	uint32_t limits = 0;
+	// queue families beyond the graphics queue, which the device needs anyway
+	uint32_t queues = 0;
+	// optional features the app makes use of
+	uint32_t features = 0;
+
+	uint32_t total() const {
+		return type + memory + limits + queues + features;
+	}
+};
+
+// every device the instance reports, whether or not the app can run on it
+struct DeviceCandidate {
+	VkPhysicalDevice device = VK_NULL_HANDLE;
+	// position in vkEnumeratePhysicalDevices order, which is what a numeric selector refers to
+	uint32_t index = 0;
+	std::string name;
+	std::string uuid;
+	VkPhysicalDeviceType type = VK_PHYSICAL_DEVICE_TYPE_OTHER;
+	uint32_t apiVersion = 0;
+	VkDeviceSize deviceLocalBytes = 0;
+	DeviceScore score;
+	// empty when the app can run on the device, otherwise why not
+	std::string rejection;
+
+	bool suitable() const {
+		return rejection.empty();
+	}
+};
+
+inline std::string deviceTypeName(VkPhysicalDeviceType type) {
+	switch (type) {
+		case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+			return "discrete";
+		case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+			return "integrated";
+		case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+			return "virtual";
+		case VK_PHYSICAL_DEVICE_TYPE_CPU:
+			return "cpu";
+		default:
+			return "other";
+	}
+}
+
+// lower case hex in the usual 8-4-4-4-12 grouping
+inline std::string formatDeviceUuid(const uint8_t uuid[VK_UUID_SIZE]) {
+	std::string formatted;
+	for (uint32_t i = 0; i < VK_UUID_SIZE; i++) {
+		if (i == 4 || i == 6 || i == 8 || i == 10) {
+			formatted += '-';
+		}
+
+		char digits[3];
+		std::snprintf(digits, sizeof(digits), "%02x", uuid[i]);
+		formatted += digits;
+	}
+
+	return formatted;
+}
+
+// software ICDs such as lavapipe report themselves as CPU devices, so they are only chosen when nothing else can run the app
+inline uint32_t scoreDeviceType(VkPhysicalDeviceType type) {
+	switch (type) {
+		case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+			return 4 * DEVICE_SCORE_TYPE_WEIGHT;
+		case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+			return 3 * DEVICE_SCORE_TYPE_WEIGHT;
+		case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+			return 2 * DEVICE_SCORE_TYPE_WEIGHT;
+		case VK_PHYSICAL_DEVICE_TYPE_OTHER:
+			return DEVICE_SCORE_TYPE_WEIGHT;
+		default:
+			return 0;
+	}
+}
+
+// fills in everything but the rejection, which depends on what the app needs of the device
+inline DeviceCandidate describeDevice(VkPhysicalDevice device, uint32_t index) {
+	DeviceCandidate candidate;
+	candidate.device = device;
+	candidate.index = index;
+
+	VkPhysicalDeviceIDProperties idProperties{};
+	idProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+	VkPhysicalDeviceProperties2 properties2{};
+	properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties2.pNext = &idProperties;
+	vkGetPhysicalDeviceProperties2(device, &properties2);
+
+	const VkPhysicalDeviceProperties& properties = properties2.properties;
+	candidate.name = properties.deviceName;
+	candidate.uuid = formatDeviceUuid(idProperties.deviceUUID);
+	candidate.type = properties.deviceType;
+	candidate.apiVersion = properties.apiVersion;
+
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+	vkGetPhysicalDeviceMemoryProperties(device, &memoryProperties);
+	for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++) {
+		if (memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+			candidate.deviceLocalBytes += memoryProperties.memoryHeaps[i].size;
+		}
+	}
+
+	candidate.score.type = scoreDeviceType(properties.deviceType);
+	candidate.score.memory = 8 * static_cast<uint32_t>(std::min<VkDeviceSize>(candidate.deviceLocalBytes >> 30, 64));
+	candidate.score.limits = std::min<uint32_t>(properties.limits.maxImageDimension2D / 1024, 32) + std::min<uint32_t>(properties.limits.maxComputeWorkGroupInvocations / 64, 32);
+
+	// queues the app may move transfers or compute onto, so they overlap with the graphics queue
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
+
+	bool dedicatedTransfer = false;
+	bool asyncCompute = false;
+	for (const auto& queueFamily : queueFamilies) {
+		bool graphics = (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+		bool compute = (queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT) != 0;
+		dedicatedTransfer = dedicatedTransfer || (!graphics && !compute && (queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) != 0);
+		asyncCompute = asyncCompute || (!graphics && compute);
+	}
+	candidate.score.queues = (dedicatedTransfer ? 50 : 0) + (asyncCompute ? 50 : 0);
+
+	VkPhysicalDeviceFeatures features;
+	vkGetPhysicalDeviceFeatures(device, &features);
+	VkBool32 optionalFeatures[] = {features.multiDrawIndirect, features.drawIndirectFirstInstance, features.pipelineStatisticsQuery, features.fillModeNonSolid, properties.limits.timestampComputeAndGraphics};
+	for (VkBool32 supported : optionalFeatures) {
+		candidate.score.features += supported == VK_TRUE ? 25 : 0;
+	}
+
+	return candidate;
+}
+
+inline std::string toLowerCase(std::string value) {
+	std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+	return value;
+}
+
+// a selector is an index, a UUID (dashes optional) or part of a device's name, ignoring case
+inline bool matchesDeviceSelector(const DeviceCandidate& candidate, const std::string& selector) {
+	if (!selector.empty() && std::all_of(selector.begin(), selector.end(), [](unsigned char c) { return std::isdigit(c); })) {
+		return std::stoul(selector) == candidate.index;
+	}
+
+	std::string lowerSelector = toLowerCase(selector);
+	std::string undashedSelector = lowerSelector;
+	undashedSelector.erase(std::remove(undashedSelector.begin(), undashedSelector.end(), '-'), undashedSelector.end());
+	std::string undashedUuid = candidate.uuid;
+	undashedUuid.erase(std::remove(undashedUuid.begin(), undashedUuid.end(), '-'), undashedUuid.end());
+
+	return undashedSelector == undashedUuid || toLowerCase(candidate.name).find(lowerSelector) != std::string::npos;
+}
+
+// the position in candidates of the device to use, the highest scoring suitable one unless a selector names another
+// a selector which matches nothing, or only devices the app cannot run on, is an error rather than a silent fallback
+inline size_t selectDevice(const std::vector<DeviceCandidate>& candidates, const std::string& selector) {
+	const size_t NONE = candidates.size();
+	size_t chosen = NONE;
+	std::string rejections;
+
+	for (size_t i = 0; i < candidates.size(); i++) {
+		const DeviceCandidate& candidate = candidates[i];
+		if (!selector.empty() && !matchesDeviceSelector(candidate, selector)) {
+			continue;
+		}
+
+		if (!candidate.suitable()) {
+			rejections += "\n\t" + candidate.name + ": " + candidate.rejection;
+			continue;
+		}
+
+		if (chosen == NONE || candidate.score.total() > candidates[chosen].score.total()) {
+			chosen = i;
+		}
+	}
+
+	if (chosen == NONE) {
+		if (!selector.empty() && rejections.empty()) {
+			throw std::runtime_error("ERROR: No device matches " + selector + ", see --list-devices");
+		}
+		throw std::runtime_error("ERROR: Failed to find suitable device" + (selector.empty() ? std::string() : " matching " + selector) + rejections);
+	}
+
+	return chosen;
+}
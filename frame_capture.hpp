@@ -0,0 +1,327 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <cstdio>
+
+#include "app_config.hpp"
+#include "frame_timeline.hpp"
+#include "gpu_buffer.hpp"
+#include "image_encoders.hpp"
+
+// number of readback buffers, frames arriving while all of them are in flight or waiting to be written are dropped
+const uint32_t FRAME_CAPTURE_SLOTS = 4;
+
+// frame rate written into captured video, as frames are captured at whatever rate they render
+const uint32_t FRAME_CAPTURE_VIDEO_FPS = 60;
+
+struct FrameCaptureStats {
+	// frames copied into a readback buffer
+	uint64_t framesCaptured = 0;
+	uint64_t framesWritten = 0;
+	// frames not captured because every readback buffer was still busy, i.e. the writer fell behind
+	uint64_t framesDropped = 0;
+	// frames not captured because the swapchain no longer matched the size capture started at
+	uint64_t framesSkipped = 0;
+	uint64_t bytesWritten = 0;
+	// time the writer thread spent encoding and writing
+	double writeSeconds = 0.0;
+
+	double bytesPerSecond() const {
+		return writeSeconds > 0.0 ? bytesWritten / writeSeconds : 0.0;
+	}
+};
+
+// copies rendered frames into a ring of host visible buffers, which a background thread encodes and writes to disk once their frame has finished
+// the render loop never waits for the writer, when it falls behind frames are dropped and counted instead
+class FrameCapture {
+	public:
+		FrameCapture() = default;
+		FrameCapture(const FrameCapture&) = delete;
+		FrameCapture& operator=(const FrameCapture&) = delete;
+
+		~FrameCapture() {
+			stopWriter();
+		}
+
+		void create(GpuAllocator& gpuAllocator, VkDevice logicalDevice, FrameTimeline& frameTimeline, VkFormat imageFormat, VkExtent2D imageExtent, CaptureFormat captureFormat, const std::string& captureDirectory) {
+			allocator = &gpuAllocator;
+			device = logicalDevice;
+			timeline = &frameTimeline;
+			extent = imageExtent;
+			format = captureFormat;
+			directory = captureDirectory;
+
+			if (imageFormat == VK_FORMAT_B8G8R8A8_SRGB || imageFormat == VK_FORMAT_B8G8R8A8_UNORM) {
+				bgra = true;
+			}
+			else if (imageFormat == VK_FORMAT_R8G8B8A8_SRGB || imageFormat == VK_FORMAT_R8G8B8A8_UNORM) {
+				bgra = false;
+			}
+			else {
+				throw std::runtime_error("ERROR: Frame capture only supports 8 bit RGBA and BGRA images");
+			}
+
+			std::filesystem::create_directories(directory);
+			if (format == CaptureFormat::Video) {
+				video.open(directory + "/capture.y4m", extent.width, extent.height, FRAME_CAPTURE_VIDEO_FPS);
+			}
+
+			// cached memory makes the writer's reads of the buffers fast, coherent memory is the fallback every device has
+			VkDeviceSize bufferSize = VkDeviceSize(extent.width) * extent.height * 4;
+			slots.resize(FRAME_CAPTURE_SLOTS);
+			for (auto& slot : slots) {
+				try {
+					slot.buffer = createBuffer(*allocator, device, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+				}
+				catch (const std::runtime_error&) {
+					slot.buffer = createBuffer(*allocator, device, bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+				}
+			}
+
+			writer = std::thread([this] { writerLoop(); });
+		}
+
+		void destroy() {
+			if (device == VK_NULL_HANDLE) {
+				return;
+			}
+
+			stopWriter();
+			for (auto& slot : slots) {
+				destroyBuffer(*allocator, device, slot.buffer);
+			}
+			video.close();
+		}
+
+		// must be recorded outside of a render pass, after the image was last written, which leaves it in layout again
+		void cmdCapture(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout layout, VkExtent2D imageExtent, uint64_t frame) {
+			if (imageExtent.width != extent.width || imageExtent.height != extent.height) {
+				stats.framesSkipped++;
+				return;
+			}
+
+			Slot* slot = nullptr;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				for (auto& candidate : slots) {
+					if (candidate.state == SlotState::Free) {
+						slot = &candidate;
+						break;
+					}
+				}
+
+				if (slot == nullptr) {
+					stats.framesDropped++;
+					return;
+				}
+
+				slot->state = SlotState::InFlight;
+				slot->frame = frame;
+				stats.framesCaptured++;
+			}
+
+			VkImageMemoryBarrier toTransfer{};
+			toTransfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			toTransfer.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+			toTransfer.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+			toTransfer.oldLayout = layout;
+			toTransfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+			toTransfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			toTransfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			toTransfer.image = image;
+			toTransfer.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+
+			VkBufferImageCopy region{};
+			region.bufferOffset = 0;
+			region.bufferRowLength = 0; // tightly packed
+			region.bufferImageHeight = 0;
+			region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+			region.imageOffset = {0, 0, 0};
+			region.imageExtent = {extent.width, extent.height, 1};
+			vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot->buffer.buffer, 1, &region);
+
+			// return the image to the layout it is presented (or next rendered) from
+			if (layout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) {
+				VkImageMemoryBarrier toPresent = toTransfer;
+				toPresent.srcAccessMask = 0;
+				toPresent.dstAccessMask = 0;
+				toPresent.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+				toPresent.newLayout = layout;
+				vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &toPresent);
+			}
+
+			// make the copy visible to the writer thread's reads once the frame has finished
+			VkBufferMemoryBarrier toHost{};
+			toHost.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			toHost.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			toHost.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+			toHost.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			toHost.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			toHost.buffer = slot->buffer.buffer;
+			toHost.offset = 0;
+			toHost.size = VK_WHOLE_SIZE;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &toHost, 0, nullptr);
+		}
+
+		// hands every captured frame which has finished on the GPU to the writer thread, in frame order, without blocking
+		void collect() {
+			std::lock_guard<std::mutex> lock(mutex);
+
+			std::vector<Slot*> finished;
+			for (auto& slot : slots) {
+				if (slot.state == SlotState::InFlight && timeline->isFrameComplete(slot.frame)) {
+					finished.push_back(&slot);
+				}
+			}
+			if (finished.empty()) {
+				return;
+			}
+
+			std::sort(finished.begin(), finished.end(), [](const Slot* a, const Slot* b) { return a->frame < b->frame; });
+			for (Slot* slot : finished) {
+				slot->state = SlotState::Queued;
+				queue.push_back(slot);
+			}
+			queueCondition.notify_one();
+		}
+
+		// writes out everything captured so far and stops the writer, call once the device is idle, rethrows the writer's first error
+		void finish() {
+			if (!writer.joinable()) {
+				return;
+			}
+
+			collect();
+			stopWriter();
+			video.close();
+
+			if (writerError) {
+				std::rethrow_exception(writerError);
+			}
+		}
+
+		FrameCaptureStats getStats() {
+			std::lock_guard<std::mutex> lock(mutex);
+			return stats;
+		}
+
+	private:
+		enum class SlotState {
+			Free,
+			// the copy has been recorded and its frame may not have finished yet
+			InFlight,
+			// waiting for or being written by the writer thread
+			Queued
+		};
+
+		struct Slot {
+			GpuBuffer buffer;
+			SlotState state = SlotState::Free;
+			uint64_t frame = 0;
+		};
+
+		GpuAllocator* allocator = nullptr;
+		VkDevice device = VK_NULL_HANDLE;
+		FrameTimeline* timeline = nullptr;
+		VkExtent2D extent{};
+		bool bgra = true;
+
+		CaptureFormat format = CaptureFormat::Ppm;
+		std::string directory;
+		// only touched by the writer thread once it has started
+		Y4mWriter video;
+
+		std::vector<Slot> slots;
+		FrameCaptureStats stats;
+
+		std::thread writer;
+		std::mutex mutex;
+		std::condition_variable queueCondition;
+		std::deque<Slot*> queue;
+		bool stopping = false;
+		std::exception_ptr writerError;
+
+		void stopWriter() {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				stopping = true;
+			}
+			queueCondition.notify_one();
+
+			if (writer.joinable()) {
+				writer.join();
+			}
+		}
+
+		// drains the queue before exiting, so stopping never loses a captured frame
+		void writerLoop() {
+			while (true) {
+				Slot* slot;
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					queueCondition.wait(lock, [this] { return stopping || !queue.empty(); });
+					if (queue.empty()) {
+						return;
+					}
+					slot = queue.front();
+					queue.pop_front();
+				}
+
+				auto writeStart = std::chrono::steady_clock::now();
+				size_t bytes = 0;
+
+				if (!writerError) {
+					try {
+						bytes = writeFrame(*slot);
+					}
+					catch (...) {
+						writerError = std::current_exception();
+					}
+				}
+
+				double writeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - writeStart).count();
+
+				std::lock_guard<std::mutex> lock(mutex);
+				if (bytes > 0) {
+					stats.framesWritten++;
+					stats.bytesWritten += bytes;
+				}
+				stats.writeSeconds += writeSeconds;
+				slot->state = SlotState::Free;
+			}
+		}
+
+		size_t writeFrame(const Slot& slot) {
+			CapturedImage image = {static_cast<const uint8_t*>(slot.buffer.allocation.mapped), extent.width, extent.height, bgra};
+
+			if (format == CaptureFormat::Video) {
+				return video.writeFrame(image);
+			}
+
+			char name[32];
+			std::snprintf(name, sizeof(name), "frame_%06llu", static_cast<unsigned long long>(slot.frame));
+			std::string path = directory + "/" + name;
+
+			switch (format) {
+				case CaptureFormat::Raw:
+					return writeRawImage(path + ".raw", image);
+				case CaptureFormat::Png:
+					return writePng(path + ".png", image);
+				default:
+					return writePpm(path + ".ppm", image);
+			}
+		}
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+struct PercentileSummary {
+	size_t count = 0;
+	double p50 = 0.0;
+	double p95 = 0.0;
+	double p99 = 0.0;
+};
+
+// fixed capacity ring of samples, once full the oldest sample is overwritten so memory use stays bounded however long the app runs
+class SampleRing {
+	public:
+		explicit SampleRing(size_t capacity = 1024) : capacity(capacity) {
+			samples.reserve(capacity);
+		}
+
+		void push(double sample) {
+			if (samples.size() < capacity) {
+				samples.push_back(sample);
+			}
+			else {
+				samples[next] = sample;
+			}
+			next = (next + 1) % capacity;
+		}
+
+		size_t size() const {
+			return samples.size();
+		}
+
+		PercentileSummary summarise() const {
+			PercentileSummary summary;
+			summary.count = samples.size();
+
+			if (samples.empty()) {
+				return summary;
+			}
+
+			// sort a copy so the ring keeps its insertion order
+			std::vector<double> sorted(samples);
+			std::sort(sorted.begin(), sorted.end());
+
+			summary.p50 = percentile(sorted, 0.50);
+			summary.p95 = percentile(sorted, 0.95);
+			summary.p99 = percentile(sorted, 0.99);
+
+			return summary;
+		}
+
+	private:
+		size_t capacity;
+		size_t next = 0;
+		std::vector<double> samples;
+
+		static double percentile(const std::vector<double>& sorted, double fraction) {
+			// nearest rank percentile
+			size_t rank = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+			return sorted[std::min(rank, sorted.size() - 1)];
+		}
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <stdexcept>
+#include <cstdint>
+
+// one timeline semaphore counting finished frames, frame N (numbered from 1) signals the value N when its GPU work completes
+// replaces a fence per frame in flight, and lets anything holding a frame number ask whether that frame has finished without blocking
+class FrameTimeline {
+	public:
+		void create(VkDevice logicalDevice) {
+			device = logicalDevice;
+
+			VkSemaphoreTypeCreateInfo typeCreateInfo{};
+			typeCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+			typeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+			typeCreateInfo.initialValue = 0;
+
+			VkSemaphoreCreateInfo semaphoreCreateInfo{};
+			semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+			semaphoreCreateInfo.pNext = &typeCreateInfo;
+
+			if (vkCreateSemaphore(device, &semaphoreCreateInfo, nullptr, &semaphore) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to create frame timeline semaphore");
+			}
+		}
+
+		void destroy() {
+			if (device == VK_NULL_HANDLE) {
+				return;
+			}
+
+			vkDestroySemaphore(device, semaphore, nullptr);
+		}
+
+		VkSemaphore getSemaphore() const {
+			return semaphore;
+		}
+
+		// newest frame known to have finished, reads the semaphore's current value
+		uint64_t getCompletedFrame() {
+			uint64_t value;
+			if (vkGetSemaphoreCounterValue(device, semaphore, &value) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to read frame timeline semaphore");
+			}
+			completedFrame = value;
+
+			return completedFrame;
+		}
+
+		bool isFrameComplete(uint64_t frame) {
+			// frames complete in order, so once one is seen finished every earlier one is too and the semaphore need not be read again
+			return frame <= completedFrame || frame <= getCompletedFrame();
+		}
+
+		void waitForFrame(uint64_t frame) {
+			if (frame <= completedFrame) {
+				return;
+			}
+
+			VkSemaphoreWaitInfo waitInfo{};
+			waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+			waitInfo.semaphoreCount = 1;
+			waitInfo.pSemaphores = &semaphore;
+			waitInfo.pValues = &frame;
+
+			if (vkWaitSemaphores(device, &waitInfo, UINT64_MAX) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to wait for frame timeline semaphore");
+			}
+			completedFrame = frame;
+		}
+
+	private:
+		VkDevice device = VK_NULL_HANDLE;
+		VkSemaphore semaphore = VK_NULL_HANDLE;
+		// cached lower bound of the semaphore's value
+		uint64_t completedFrame = 0;
+};
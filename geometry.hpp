@@ -0,0 +1,167 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+// vertex layout consumed by shader.vert, bound at binding 0
+struct Vertex {
+	float position[3];
+	float colour[3];
+
+	static VkVertexInputBindingDescription getBindingDescription() {
+		VkVertexInputBindingDescription bindingDescription{};
+		bindingDescription.binding = 0;
+		bindingDescription.stride = sizeof(Vertex);
+		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+		return bindingDescription;
+	}
+
+	static std::array<VkVertexInputAttributeDescription, 2> getAttributeDescriptions() {
+		std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions{};
+
+		attributeDescriptions[0].binding = 0;
+		attributeDescriptions[0].location = 0;
+		attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+		attributeDescriptions[0].offset = offsetof(Vertex, position);
+
+		attributeDescriptions[1].binding = 0;
+		attributeDescriptions[1].location = 1;
+		attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
+		attributeDescriptions[1].offset = offsetof(Vertex, colour);
+
+		return attributeDescriptions;
+	}
+};
+
+// per-instance data read through an instance rate binding at binding 1, packed into 16 bytes so millions of instances stay cheap to fetch
+struct InstanceData {
+	float offset[2];
+	float scale;
+	// RGBA8, multiplied with the vertex colour
+	uint32_t colour;
+
+	static VkVertexInputBindingDescription getBindingDescription() {
+		VkVertexInputBindingDescription bindingDescription{};
+		bindingDescription.binding = 1;
+		bindingDescription.stride = sizeof(InstanceData);
+		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+		return bindingDescription;
+	}
+
+	static std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions() {
+		std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions{};
+
+		attributeDescriptions[0].binding = 1;
+		attributeDescriptions[0].location = 2;
+		attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
+		attributeDescriptions[0].offset = offsetof(InstanceData, offset);
+
+		attributeDescriptions[1].binding = 1;
+		attributeDescriptions[1].location = 3;
+		attributeDescriptions[1].format = VK_FORMAT_R32_SFLOAT;
+		attributeDescriptions[1].offset = offsetof(InstanceData, scale);
+
+		attributeDescriptions[2].binding = 1;
+		attributeDescriptions[2].location = 4;
+		attributeDescriptions[2].format = VK_FORMAT_R8G8B8A8_UNORM;
+		attributeDescriptions[2].offset = offsetof(InstanceData, colour);
+
+		return attributeDescriptions;
+	}
+};
+
+static_assert(sizeof(InstanceData) == 16, "InstanceData must stay tightly packed");
+
+inline uint32_t instanceGridSide(uint32_t count) {
+	return static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+}
+
+// centre of instance index on a grid of side cells a side, so it can be found without the instance buffer
+inline void instanceGridPosition(uint32_t index, uint32_t side, float position[2]) {
+	float cellSize = 2.0f / side;
+	position[0] = -1.0f + (index % side + 0.5f) * cellSize;
+	position[1] = -1.0f + (index / side + 0.5f) * cellSize;
+}
+
+// lays the instances out on a square grid covering the viewport, a single instance is drawn at its original size and colour
+inline std::vector<InstanceData> makeInstanceGrid(uint32_t count) {
+	std::vector<InstanceData> instances(count);
+
+	uint32_t side = instanceGridSide(count);
+	float scale = std::min(1.0f, 1.6f / side);
+
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t column = i % side;
+		uint32_t row = i / side;
+
+		instanceGridPosition(i, side, instances[i].offset);
+		instances[i].scale = scale;
+
+		// vary the tint across the grid so individual instances can be told apart
+		uint32_t red = count == 1 ? 255 : 128 + (column * 127) / side;
+		uint32_t green = count == 1 ? 255 : 128 + (row * 127) / side;
+		uint32_t blue = 255;
+		instances[i].colour = red | (green << 8) | (blue << 16) | (255u << 24);
+	}
+
+	return instances;
+}
+
+// indexed geometry on the CPU, indices are 32 bit so a single mesh can address tens of millions of vertices
+struct Mesh {
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+};
+
+// furthest any vertex lies from the mesh origin in the view plane, the culling bounds are squares of this radius
+inline float meshBoundingRadius(const Mesh& mesh) {
+	float boundingRadius = 0.0f;
+	for (const auto& vertex : mesh.vertices) {
+		boundingRadius = std::max(boundingRadius, std::sqrt(vertex.position[0] * vertex.position[0] + vertex.position[1] * vertex.position[1]));
+	}
+
+	return boundingRadius;
+}
+
+// true when every index addresses one of the vertices, as index fetches are not bounds checked without robustBufferAccess
+inline bool indicesInRange(const uint32_t* indices, size_t indexCount, size_t vertexCount) {
+	uint32_t maxIndex = 0;
+	for (size_t i = 0; i < indexCount; i++) {
+		maxIndex = std::max(maxIndex, indices[i]);
+	}
+
+	return indexCount == 0 || maxIndex < vertexCount;
+}
+
+inline Mesh makeTriangleMesh() {
+	Mesh mesh;
+	mesh.vertices = {
+		{{0.0f, -0.5f, 0.0f}, {1.0f, 0.0f, 0.0f}},
+		{{0.5f, 0.5f, 0.0f}, {0.0f, 1.0f, 0.0f}},
+		{{-0.5f, 0.5f, 0.0f}, {0.0f, 0.0f, 1.0f}}
+	};
+	mesh.indices = {0, 1, 2};
+
+	return mesh;
+}
+
+// writes the mesh's vertices rotated about the view axis, used to exercise the per-frame streaming path
+inline void writeRotatedVertices(const Mesh& mesh, float angle, Vertex* destination) {
+	float c = std::cos(angle);
+	float s = std::sin(angle);
+
+	for (size_t i = 0; i < mesh.vertices.size(); i++) {
+		Vertex vertex = mesh.vertices[i];
+		vertex.position[0] = c * mesh.vertices[i].position[0] - s * mesh.vertices[i].position[1];
+		vertex.position[1] = s * mesh.vertices[i].position[0] + c * mesh.vertices[i].position[1];
+		destination[i] = vertex;
+	}
+}
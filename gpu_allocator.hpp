@@ -0,0 +1,369 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+
+// size of the blocks sub-allocated from, smaller heaps use an eighth of the heap instead
+const VkDeviceSize GPU_ALLOCATOR_BLOCK_SIZE = 64 * 1024 * 1024;
+// fraction of a heap's budget above which new blocks print a warning
+const double GPU_ALLOCATOR_BUDGET_WARNING = 0.9;
+
+inline uint32_t findMemoryTypeIndex(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties) {
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+	// find a memory type allowed by the resource which has all of the requested properties
+	for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+		if ((typeFilter & (1 << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+			return i;
+		}
+	}
+
+	throw std::runtime_error("ERROR: Failed to find suitable memory type");
+}
+
+// buffers and optimal tiling images are kept in separate blocks, so bufferImageGranularity never has to pad between neighbours
+enum class ResourceKind {
+	Buffer,
+	OptimalImage
+};
+
+struct GpuMemoryBlock;
+
+struct GpuAllocation {
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	VkDeviceSize offset = 0;
+	VkDeviceSize size = 0;
+	// pointer to the start of the allocation if its memory is host visible, blocks are mapped once for their whole lifetime
+	void* mapped = nullptr;
+
+	GpuMemoryBlock* block = nullptr;
+};
+
+struct GpuHeapBudget {
+	VkDeviceSize size;
+	// from VK_EXT_memory_budget when enabled, otherwise the heap size and the bytes this allocator has reserved
+	VkDeviceSize budget;
+	VkDeviceSize usage;
+};
+
+struct GpuAllocatorStats {
+	VkDeviceSize bytesUsed = 0;
+	VkDeviceSize bytesReserved = 0;
+	uint32_t blockCount = 0;
+	uint32_t allocationCount = 0;
+	// 1 - largest free range / total free bytes over all blocks, 0 when all free space is contiguous
+	double fragmentation = 0.0;
+	bool budgetFromExtension = false;
+	bool nearBudget = false;
+	std::vector<GpuHeapBudget> heaps;
+};
+
+struct GpuMemoryBlock {
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	VkDeviceSize size = 0;
+	void* mapped = nullptr;
+	uint32_t memoryTypeIndex = 0;
+	ResourceKind kind = ResourceKind::Buffer;
+	// blocks holding a single allocation too large to share a block are released as soon as it is freed
+	bool dedicated = false;
+
+	VkDeviceSize used = 0;
+	uint32_t allocationCount = 0;
+
+	// free ranges by offset, merged with their neighbours as allocations are freed
+	std::map<VkDeviceSize, VkDeviceSize> freeRanges;
+};
+
+// sub-allocates buffers and images from large vkAllocateMemory blocks, one set of blocks per memory type and resource kind
+// per-frame data lives in the streaming rings, which reuse one long lived buffer each, so every block is a free list
+// this keeps the number of device allocations far below maxMemoryAllocationCount and avoids a driver call per resource
+class GpuAllocator {
+	public:
+		void create(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, bool memoryBudgetEnabled) {
+			pDevice = physicalDevice;
+			device = logicalDevice;
+			budgetExtension = memoryBudgetEnabled;
+
+			vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+			VkPhysicalDeviceProperties deviceProperties;
+			vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+			maxAllocationCount = deviceProperties.limits.maxMemoryAllocationCount;
+
+			pools.resize(VK_MAX_MEMORY_TYPES * 2);
+			heapReserved.assign(memoryProperties.memoryHeapCount, 0);
+			heapWarned.assign(memoryProperties.memoryHeapCount, false);
+		}
+
+		void destroy() {
+			for (auto& pool : pools) {
+				for (auto& block : pool) {
+					vkFreeMemory(device, block->memory, nullptr);
+				}
+				pool.clear();
+			}
+		}
+
+		GpuAllocation allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, ResourceKind kind) {
+			std::lock_guard<std::mutex> lock(mutex);
+
+			uint32_t memoryTypeIndex = findMemoryTypeIndex(pDevice, requirements.memoryTypeBits, properties);
+			auto& pool = pools[poolIndex(memoryTypeIndex, kind)];
+			VkDeviceSize blockSize = preferredBlockSize(memoryTypeIndex);
+
+			GpuAllocation allocation;
+
+			// allocations too large to share a block get one to themselves rather than wasting most of a fresh block
+			if (requirements.size > blockSize / 2) {
+				GpuMemoryBlock* block = createBlock(pool, memoryTypeIndex, requirements.size, kind, true);
+				allocateFromBlock(*block, requirements.size, requirements.alignment, allocation);
+				return allocation;
+			}
+
+			for (auto& block : pool) {
+				if (!block->dedicated && allocateFromBlock(*block, requirements.size, requirements.alignment, allocation)) {
+					return allocation;
+				}
+			}
+
+			GpuMemoryBlock* block = createBlock(pool, memoryTypeIndex, blockSize, kind, false);
+			allocateFromBlock(*block, requirements.size, requirements.alignment, allocation);
+
+			return allocation;
+		}
+
+		void free(GpuAllocation& allocation) {
+			if (allocation.block == nullptr) {
+				return;
+			}
+
+			std::lock_guard<std::mutex> lock(mutex);
+
+			GpuMemoryBlock* block = allocation.block;
+			block->used -= allocation.size;
+			block->allocationCount--;
+
+			insertFreeRange(*block, allocation.offset, allocation.size);
+
+			if (block->dedicated) {
+				releaseBlock(block);
+			}
+
+			allocation = GpuAllocation{};
+		}
+
+		GpuAllocatorStats getStats() {
+			std::lock_guard<std::mutex> lock(mutex);
+
+			GpuAllocatorStats stats;
+			VkDeviceSize totalFree = 0;
+			VkDeviceSize largestFree = 0;
+
+			for (const auto& pool : pools) {
+				for (const auto& block : pool) {
+					stats.bytesUsed += block->used;
+					stats.bytesReserved += block->size;
+					stats.blockCount++;
+					stats.allocationCount += block->allocationCount;
+
+					for (const auto& range : block->freeRanges) {
+						totalFree += range.second;
+						largestFree = std::max(largestFree, range.second);
+					}
+				}
+			}
+
+			if (totalFree > 0) {
+				stats.fragmentation = 1.0 - static_cast<double>(largestFree) / static_cast<double>(totalFree);
+			}
+
+			stats.budgetFromExtension = budgetExtension;
+			stats.heaps = queryHeapBudgets();
+			for (const auto& heap : stats.heaps) {
+				if (heap.usage > heap.budget * GPU_ALLOCATOR_BUDGET_WARNING) {
+					stats.nearBudget = true;
+				}
+			}
+
+			return stats;
+		}
+
+	private:
+		VkPhysicalDevice pDevice = VK_NULL_HANDLE;
+		VkDevice device = VK_NULL_HANDLE;
+		VkPhysicalDeviceMemoryProperties memoryProperties{};
+		bool budgetExtension = false;
+		uint32_t maxAllocationCount = 0;
+
+		std::mutex mutex;
+		std::vector<std::vector<std::unique_ptr<GpuMemoryBlock>>> pools;
+		uint32_t deviceAllocationCount = 0;
+		std::vector<VkDeviceSize> heapReserved;
+		std::vector<bool> heapWarned;
+
+		static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+			return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+		}
+
+		static size_t poolIndex(uint32_t memoryTypeIndex, ResourceKind kind) {
+			return memoryTypeIndex * 2 + static_cast<size_t>(kind);
+		}
+
+		VkDeviceSize preferredBlockSize(uint32_t memoryTypeIndex) {
+			VkDeviceSize heapSize = memoryProperties.memoryHeaps[memoryProperties.memoryTypes[memoryTypeIndex].heapIndex].size;
+			return std::min(GPU_ALLOCATOR_BLOCK_SIZE, heapSize / 8);
+		}
+
+		GpuMemoryBlock* createBlock(std::vector<std::unique_ptr<GpuMemoryBlock>>& pool, uint32_t memoryTypeIndex, VkDeviceSize size, ResourceKind kind, bool dedicated) {
+			if (deviceAllocationCount >= maxAllocationCount) {
+				throw std::runtime_error("ERROR: Device memory allocation count limit reached");
+			}
+
+			uint32_t heapIndex = memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+			checkBudget(heapIndex, size);
+
+			auto block = std::make_unique<GpuMemoryBlock>();
+			block->size = size;
+			block->memoryTypeIndex = memoryTypeIndex;
+			block->kind = kind;
+			block->dedicated = dedicated;
+
+			VkMemoryAllocateInfo allocateInfo{};
+			allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			allocateInfo.allocationSize = size;
+			allocateInfo.memoryTypeIndex = memoryTypeIndex;
+
+			if (vkAllocateMemory(device, &allocateInfo, nullptr, &block->memory) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to allocate device memory block");
+			}
+
+			// host visible blocks stay mapped, mapping is not free and a block may only be mapped once at a time
+			if (memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+				vkMapMemory(device, block->memory, 0, size, 0, &block->mapped);
+			}
+
+			block->freeRanges[0] = size;
+
+			deviceAllocationCount++;
+			heapReserved[heapIndex] += size;
+
+			pool.push_back(std::move(block));
+			return pool.back().get();
+		}
+
+		void releaseBlock(GpuMemoryBlock* block) {
+			auto& pool = pools[poolIndex(block->memoryTypeIndex, block->kind)];
+
+			heapReserved[memoryProperties.memoryTypes[block->memoryTypeIndex].heapIndex] -= block->size;
+			deviceAllocationCount--;
+			vkFreeMemory(device, block->memory, nullptr);
+
+			pool.erase(std::remove_if(pool.begin(), pool.end(), [block](const std::unique_ptr<GpuMemoryBlock>& b) { return b.get() == block; }), pool.end());
+		}
+
+		bool allocateFromBlock(GpuMemoryBlock& block, VkDeviceSize size, VkDeviceSize alignment, GpuAllocation& allocation) {
+			VkDeviceSize offset = 0;
+
+			// first fit, splitting the range into whatever is left either side of the allocation
+			auto range = block.freeRanges.begin();
+			for (; range != block.freeRanges.end(); ++range) {
+				offset = alignUp(range->first, alignment);
+				if (offset + size <= range->first + range->second) {
+					break;
+				}
+			}
+			if (range == block.freeRanges.end()) {
+				return false;
+			}
+
+			VkDeviceSize rangeStart = range->first;
+			VkDeviceSize rangeEnd = range->first + range->second;
+			block.freeRanges.erase(range);
+
+			if (offset > rangeStart) {
+				block.freeRanges[rangeStart] = offset - rangeStart;
+			}
+			if (offset + size < rangeEnd) {
+				block.freeRanges[offset + size] = rangeEnd - (offset + size);
+			}
+
+			block.used += size;
+			block.allocationCount++;
+
+			allocation.memory = block.memory;
+			allocation.offset = offset;
+			allocation.size = size;
+			allocation.mapped = block.mapped != nullptr ? static_cast<char*>(block.mapped) + offset : nullptr;
+			allocation.block = &block;
+
+			return true;
+		}
+
+		void insertFreeRange(GpuMemoryBlock& block, VkDeviceSize offset, VkDeviceSize size) {
+			auto inserted = block.freeRanges.emplace(offset, size).first;
+
+			// merge with the following range
+			auto next = std::next(inserted);
+			if (next != block.freeRanges.end() && inserted->first + inserted->second == next->first) {
+				inserted->second += next->second;
+				block.freeRanges.erase(next);
+			}
+
+			// merge with the preceding range
+			if (inserted != block.freeRanges.begin()) {
+				auto previous = std::prev(inserted);
+				if (previous->first + previous->second == inserted->first) {
+					previous->second += inserted->second;
+					block.freeRanges.erase(inserted);
+				}
+			}
+		}
+
+		std::vector<GpuHeapBudget> queryHeapBudgets() {
+			std::vector<GpuHeapBudget> heaps(memoryProperties.memoryHeapCount);
+
+			VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties{};
+			budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+			if (budgetExtension) {
+				VkPhysicalDeviceMemoryProperties2 memoryProperties2{};
+				memoryProperties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+				memoryProperties2.pNext = &budgetProperties;
+				vkGetPhysicalDeviceMemoryProperties2(pDevice, &memoryProperties2);
+			}
+
+			for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++) {
+				heaps[i].size = memoryProperties.memoryHeaps[i].size;
+
+				// the extension accounts for other processes too, without it only this allocator's own blocks are known
+				heaps[i].budget = budgetExtension ? budgetProperties.heapBudget[i] : memoryProperties.memoryHeaps[i].size;
+				heaps[i].usage = budgetExtension ? budgetProperties.heapUsage[i] : heapReserved[i];
+			}
+
+			return heaps;
+		}
+
+		void checkBudget(uint32_t heapIndex, VkDeviceSize size) {
+			GpuHeapBudget heap = queryHeapBudgets()[heapIndex];
+
+			// exceeding the budget is allowed but is likely to cause paging or allocation failure, so only warn
+			if (heap.usage + size > heap.budget * GPU_ALLOCATOR_BUDGET_WARNING) {
+				if (!heapWarned[heapIndex]) {
+					std::cerr << "WARNING: Memory heap " << heapIndex << " is close to its budget (" << (heap.usage + size) / (1024 * 1024) << " of " << heap.budget / (1024 * 1024) << " MiB)" << std::endl;
+					heapWarned[heapIndex] = true;
+				}
+			}
+			else {
+				heapWarned[heapIndex] = false;
+			}
+		}
+};
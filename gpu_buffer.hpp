@@ -0,0 +1,268 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+#include "frame_timeline.hpp"
+#include "gpu_allocator.hpp"
+
+// size of the staging buffer used for uploads, larger uploads are streamed through it in chunks
+const VkDeviceSize STAGING_BUFFER_SIZE = 16 * 1024 * 1024;
+// the staging buffer is split into this many chunks, so the next chunk is written while the previous one is being copied
+const uint32_t STAGING_CHUNK_COUNT = 2;
+const VkDeviceSize STAGING_CHUNK_SIZE = STAGING_BUFFER_SIZE / STAGING_CHUNK_COUNT;
+
+struct GpuBuffer {
+	VkBuffer buffer = VK_NULL_HANDLE;
+	GpuAllocation allocation;
+	VkDeviceSize size = 0;
+};
+
+inline GpuBuffer createBuffer(GpuAllocator& allocator, VkDevice device, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) {
+	GpuBuffer result;
+	result.size = size;
+
+	VkBufferCreateInfo bufferCreateInfo{};
+	bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferCreateInfo.size = size;
+	bufferCreateInfo.usage = usage;
+	bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	if (vkCreateBuffer(device, &bufferCreateInfo, nullptr, &result.buffer) != VK_SUCCESS) {
+		throw std::runtime_error("ERROR: Failed to create buffer");
+	}
+
+	VkMemoryRequirements memoryRequirements;
+	vkGetBufferMemoryRequirements(device, result.buffer, &memoryRequirements);
+
+	try {
+		result.allocation = allocator.allocate(memoryRequirements, properties, ResourceKind::Buffer);
+	}
+	catch (...) {
+		vkDestroyBuffer(device, result.buffer, nullptr);
+		throw;
+	}
+
+	vkBindBufferMemory(device, result.buffer, result.allocation.memory, result.allocation.offset);
+
+	return result;
+}
+
+inline void destroyBuffer(GpuAllocator& allocator, VkDevice device, GpuBuffer& buffer) {
+	if (buffer.buffer != VK_NULL_HANDLE) {
+		vkDestroyBuffer(device, buffer.buffer, nullptr);
+	}
+	allocator.free(buffer.allocation);
+	buffer = GpuBuffer{};
+}
+
+// copies data into device local buffers through one persistently mapped staging buffer
+// uploads larger than the staging buffer are split into chunks, so memory use stays fixed however big the scene is
+class StagingUploader {
+	public:
+		void create(GpuAllocator& gpuAllocator, VkDevice logicalDevice, uint32_t queueFamilyIndex, VkQueue transferQueue) {
+			allocator = &gpuAllocator;
+			device = logicalDevice;
+			queue = transferQueue;
+
+			// the allocator keeps host visible memory mapped, so the staging buffer is written directly
+			staging = createBuffer(*allocator, device, STAGING_BUFFER_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			stagingData = staging.allocation.mapped;
+
+			VkCommandPoolCreateInfo commandPoolCreateInfo{};
+			commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			commandPoolCreateInfo.queueFamilyIndex = queueFamilyIndex;
+			commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+			if (vkCreateCommandPool(device, &commandPoolCreateInfo, nullptr, &commandPool) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to create upload command pool");
+			}
+
+			VkCommandBufferAllocateInfo allocateInfo{};
+			allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocateInfo.commandPool = commandPool;
+			allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			allocateInfo.commandBufferCount = STAGING_CHUNK_COUNT;
+
+			if (vkAllocateCommandBuffers(device, &allocateInfo, commandBuffers) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to allocate upload command buffers");
+			}
+
+			// signalled means the chunk is free to be written
+			VkFenceCreateInfo fenceCreateInfo{};
+			fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+			fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+			for (uint32_t i = 0; i < STAGING_CHUNK_COUNT; i++) {
+				if (vkCreateFence(device, &fenceCreateInfo, nullptr, &fences[i]) != VK_SUCCESS) {
+					throw std::runtime_error("ERROR: Failed to create upload fence");
+				}
+			}
+		}
+
+		void destroy() {
+			if (device == VK_NULL_HANDLE) {
+				return;
+			}
+
+			for (auto fence : fences) {
+				vkDestroyFence(device, fence, nullptr);
+			}
+			vkDestroyCommandPool(device, commandPool, nullptr);
+			destroyBuffer(*allocator, device, staging);
+		}
+
+		// creates a device local buffer holding a copy of data, blocking until the copy has completed
+		GpuBuffer createDeviceLocalBuffer(const void* data, VkDeviceSize size, VkBufferUsageFlags usage) {
+			GpuBuffer buffer = createBuffer(*allocator, device, size, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			upload(buffer.buffer, data, size, 0);
+
+			return buffer;
+		}
+
+		// blocks until the copy has completed, data may be a mapped file, whose pages are then read straight into staging memory
+		void upload(VkBuffer destination, const void* data, VkDeviceSize size, VkDeviceSize destinationOffset) {
+			const char* source = static_cast<const char*>(data);
+
+			uint32_t chunk = 0;
+			for (VkDeviceSize copied = 0; copied < size; copied += STAGING_CHUNK_SIZE) {
+				VkDeviceSize chunkSize = std::min(STAGING_CHUNK_SIZE, size - copied);
+
+				// wait for the last copy out of this chunk, copies out of the other chunks carry on meanwhile
+				vkWaitForFences(device, 1, &fences[chunk], VK_TRUE, UINT64_MAX);
+				vkResetFences(device, 1, &fences[chunk]);
+
+				VkDeviceSize stagingOffset = chunk * STAGING_CHUNK_SIZE;
+				std::memcpy(static_cast<char*>(stagingData) + stagingOffset, source + copied, static_cast<size_t>(chunkSize));
+
+				VkCommandBuffer commandBuffer = commandBuffers[chunk];
+
+				VkCommandBufferBeginInfo beginInfo{};
+				beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+				beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+				if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+					throw std::runtime_error("ERROR: Failed to begin recording upload command buffer");
+				}
+
+				VkBufferCopy copyRegion{};
+				copyRegion.srcOffset = stagingOffset;
+				copyRegion.dstOffset = destinationOffset + copied;
+				copyRegion.size = chunkSize;
+				vkCmdCopyBuffer(commandBuffer, staging.buffer, destination, 1, &copyRegion);
+
+				if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+					throw std::runtime_error("ERROR: Failed to record upload command buffer");
+				}
+
+				VkSubmitInfo submitInfo{};
+				submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+				submitInfo.commandBufferCount = 1;
+				submitInfo.pCommandBuffers = &commandBuffer;
+
+				if (vkQueueSubmit(queue, 1, &submitInfo, fences[chunk]) != VK_SUCCESS) {
+					throw std::runtime_error("ERROR: Failed to submit upload command buffer");
+				}
+
+				chunk = (chunk + 1) % STAGING_CHUNK_COUNT;
+			}
+
+			// callers use the destination as soon as this returns
+			vkWaitForFences(device, STAGING_CHUNK_COUNT, fences, VK_TRUE, UINT64_MAX);
+		}
+
+	private:
+		GpuAllocator* allocator = nullptr;
+		VkDevice device = VK_NULL_HANDLE;
+		VkQueue queue = VK_NULL_HANDLE;
+
+		GpuBuffer staging;
+		void* stagingData = nullptr;
+
+		VkCommandPool commandPool = VK_NULL_HANDLE;
+		VkCommandBuffer commandBuffers[STAGING_CHUNK_COUNT] = {};
+		VkFence fences[STAGING_CHUNK_COUNT] = {};
+};
+
+struct StreamingAllocation {
+	VkBuffer buffer;
+	VkDeviceSize offset;
+	void* data;
+};
+
+// one persistently mapped buffer split into a fixed region per frame in flight, data written each frame is suballocated from the current region
+// frame N uses region N % regionCount, which is only reused once the frame timeline shows its previous frame has finished, so nothing is allocated or waited on per frame
+class StreamingRing {
+	public:
+		void create(VkPhysicalDevice physicalDevice, GpuAllocator& gpuAllocator, VkDevice logicalDevice, VkDeviceSize bytesPerFrame, uint32_t frameRegionCount, FrameTimeline& frameTimeline, VkBufferUsageFlags usage) {
+			allocator = &gpuAllocator;
+			device = logicalDevice;
+			regionCount = frameRegionCount;
+			timeline = &frameTimeline;
+
+			VkPhysicalDeviceProperties deviceProperties;
+			vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+
+			// keep each region aligned for any use the ring may be bound as
+			VkDeviceSize alignment = std::max<VkDeviceSize>(deviceProperties.limits.minUniformBufferOffsetAlignment, deviceProperties.limits.minStorageBufferOffsetAlignment);
+			regionSize = alignUp(bytesPerFrame, alignment);
+
+			ring = createBuffer(*allocator, device, regionSize * regionCount, usage, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			mappedData = ring.allocation.mapped;
+		}
+
+		void destroy() {
+			if (device == VK_NULL_HANDLE) {
+				return;
+			}
+
+			destroyBuffer(*allocator, device, ring);
+		}
+
+		// called before recording frame, once the frame regionCount frames earlier has been waited for
+		void beginFrame(uint64_t frame) {
+			if (frame > regionCount && !timeline->isFrameComplete(frame - regionCount)) {
+				throw std::runtime_error("ERROR: Streaming ring region reused while its frame is still in flight");
+			}
+
+			regionStart = regionSize * (frame % regionCount);
+			regionOffset = 0;
+		}
+
+		StreamingAllocation allocate(VkDeviceSize size, VkDeviceSize alignment) {
+			VkDeviceSize offset = alignUp(regionOffset, alignment);
+			if (offset + size > regionSize) {
+				throw std::runtime_error("ERROR: Streaming ring frame region exhausted");
+			}
+			regionOffset = offset + size;
+
+			return {ring.buffer, regionStart + offset, static_cast<char*>(mappedData) + regionStart + offset};
+		}
+
+		// the buffer every region is part of, for descriptors written once and pointed at each frame's data by offset
+		VkBuffer getBuffer() const {
+			return ring.buffer;
+		}
+
+	private:
+		static VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+			return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+		}
+
+		GpuAllocator* allocator = nullptr;
+		VkDevice device = VK_NULL_HANDLE;
+		uint32_t regionCount = 0;
+		FrameTimeline* timeline = nullptr;
+
+		GpuBuffer ring;
+		void* mappedData = nullptr;
+
+		VkDeviceSize regionSize = 0;
+		VkDeviceSize regionStart = 0;
+		VkDeviceSize regionOffset = 0;
+};
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <stdexcept>
+
+#include "frame_stats.hpp"
+#include "gpu_buffer.hpp"
+
+// region of the scene shown in the viewport, clip space position = (world position - offset) * scale
+// pushed to shader.vert and cull.comp so both agree on what is visible
+struct ViewTransform {
+	float offset[2];
+	float scale[2];
+};
+
+// matches the push constant block in cull.comp
+struct CullPushConstants {
+	ViewTransform view;
+	uint32_t instanceCount;
+	uint32_t indexCount;
+	float boundingRadius;
+	// non-zero to append surviving draws behind a draw count, zero to write every draw in place with instanceCount 0 when culled
+	uint32_t compact;
+};
+
+struct GpuCullingSummary {
+	PercentileSummary drawnInstances;
+	PercentileSummary culledInstances;
+};
+
+// tests every instance's bounds against the view in a compute shader and writes the survivors as indirect draws, so the CPU records the same few commands however big the scene is
+// one set of output buffers per frame in flight, as a frame's draws may still be reading them while the next frame culls
+class GpuCuller {
+	public:
+		static VkDescriptorSetLayout createDescriptorSetLayout(VkDevice logicalDevice) {
+			// instances in, draw commands and draw count out
+			VkDescriptorSetLayoutBinding bindings[3]{};
+			for (uint32_t i = 0; i < 3; i++) {
+				bindings[i].binding = i;
+				bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				bindings[i].descriptorCount = 1;
+				bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+			}
+
+			VkDescriptorSetLayoutCreateInfo layoutCreateInfo{};
+			layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+			layoutCreateInfo.bindingCount = 3;
+			layoutCreateInfo.pBindings = bindings;
+
+			VkDescriptorSetLayout layout;
+			if (vkCreateDescriptorSetLayout(logicalDevice, &layoutCreateInfo, nullptr, &layout) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to create culling descriptor set layout");
+			}
+
+			return layout;
+		}
+
+		// drawIndirectCount is null when VK_KHR_draw_indirect_count is unavailable, culled draws are then left in place with no instances
+		void create(GpuAllocator& gpuAllocator, VkDevice logicalDevice, uint32_t slotCount, VkDescriptorSetLayout descriptorSetLayout, VkBuffer instances, uint32_t instanceCount, uint32_t indexCount, float boundingRadius, PFN_vkCmdDrawIndexedIndirectCountKHR drawIndirectCount) {
+			allocator = &gpuAllocator;
+			device = logicalDevice;
+			totalInstances = instanceCount;
+			meshIndexCount = indexCount;
+			meshBoundingRadius = boundingRadius;
+			cmdDrawIndexedIndirectCount = drawIndirectCount;
+			pendingSlots.assign(slotCount, false);
+
+			VkDescriptorPoolSize poolSize{};
+			poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			poolSize.descriptorCount = slotCount * 3;
+
+			VkDescriptorPoolCreateInfo poolCreateInfo{};
+			poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+			poolCreateInfo.maxSets = slotCount;
+			poolCreateInfo.poolSizeCount = 1;
+			poolCreateInfo.pPoolSizes = &poolSize;
+
+			if (vkCreateDescriptorPool(device, &poolCreateInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to create culling descriptor pool");
+			}
+
+			std::vector<VkDescriptorSetLayout> layouts(slotCount, descriptorSetLayout);
+			descriptorSets.resize(slotCount);
+
+			VkDescriptorSetAllocateInfo setAllocateInfo{};
+			setAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			setAllocateInfo.descriptorPool = descriptorPool;
+			setAllocateInfo.descriptorSetCount = slotCount;
+			setAllocateInfo.pSetLayouts = layouts.data();
+
+			if (vkAllocateDescriptorSets(device, &setAllocateInfo, descriptorSets.data()) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to allocate culling descriptor sets");
+			}
+
+			// the draw count of each slot is copied here after the frame, so it can be read once the frame has finished
+			readback = createBuffer(*allocator, device, sizeof(uint32_t) * slotCount, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+			for (uint32_t slot = 0; slot < slotCount; slot++) {
+				drawCommands.push_back(createBuffer(*allocator, device, sizeof(VkDrawIndexedIndirectCommand) * instanceCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+				drawCounts.push_back(createBuffer(*allocator, device, sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+
+				VkDescriptorBufferInfo bufferInfos[3]{};
+				bufferInfos[0] = {instances, 0, VK_WHOLE_SIZE};
+				bufferInfos[1] = {drawCommands[slot].buffer, 0, VK_WHOLE_SIZE};
+				bufferInfos[2] = {drawCounts[slot].buffer, 0, VK_WHOLE_SIZE};
+
+				VkWriteDescriptorSet descriptorWrite{};
+				descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				descriptorWrite.dstSet = descriptorSets[slot];
+				descriptorWrite.dstBinding = 0;
+				descriptorWrite.dstArrayElement = 0;
+				descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				descriptorWrite.descriptorCount = 3;
+				descriptorWrite.pBufferInfo = bufferInfos;
+
+				vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+			}
+		}
+
+		void destroy() {
+			if (device == VK_NULL_HANDLE) {
+				return;
+			}
+
+			for (auto& buffer : drawCommands) {
+				destroyBuffer(*allocator, device, buffer);
+			}
+			for (auto& buffer : drawCounts) {
+				destroyBuffer(*allocator, device, buffer);
+			}
+			destroyBuffer(*allocator, device, readback);
+
+			vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+		}
+
+		// must be recorded outside of a render pass
+		void cmdCull(VkCommandBuffer commandBuffer, uint32_t slot, VkPipeline pipeline, VkPipelineLayout pipelineLayout, const ViewTransform& view) {
+			vkCmdFillBuffer(commandBuffer, drawCounts[slot].buffer, 0, sizeof(uint32_t), 0);
+
+			VkMemoryBarrier clearBarrier{};
+			clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+			CullPushConstants pushConstants{};
+			pushConstants.view = view;
+			pushConstants.instanceCount = totalInstances;
+			pushConstants.indexCount = meshIndexCount;
+			pushConstants.boundingRadius = meshBoundingRadius;
+			pushConstants.compact = cmdDrawIndexedIndirectCount != nullptr ? 1 : 0;
+
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSets[slot], 0, nullptr);
+			vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstants), &pushConstants);
+			vkCmdDispatch(commandBuffer, (totalInstances + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+
+			// the draws read the commands and count as indirect arguments, and the count is copied out for instrumentation
+			VkMemoryBarrier cullBarrier{};
+			cullBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			cullBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			cullBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &cullBarrier, 0, nullptr, 0, nullptr);
+		}
+
+		// records the culled draws, with the graphics pipeline and vertex buffers already bound
+		void cmdDraw(VkCommandBuffer commandBuffer, uint32_t slot) {
+			if (cmdDrawIndexedIndirectCount != nullptr) {
+				cmdDrawIndexedIndirectCount(commandBuffer, drawCommands[slot].buffer, 0, drawCounts[slot].buffer, 0, totalInstances, sizeof(VkDrawIndexedIndirectCommand));
+			}
+			else {
+				vkCmdDrawIndexedIndirect(commandBuffer, drawCommands[slot].buffer, 0, totalInstances, sizeof(VkDrawIndexedIndirectCommand));
+			}
+		}
+
+		// must be recorded outside of a render pass, after cmdCull
+		void cmdReadback(VkCommandBuffer commandBuffer, uint32_t slot) {
+			VkBufferCopy copyRegion{};
+			copyRegion.srcOffset = 0;
+			copyRegion.dstOffset = sizeof(uint32_t) * slot;
+			copyRegion.size = sizeof(uint32_t);
+			vkCmdCopyBuffer(commandBuffer, drawCounts[slot].buffer, readback.buffer, 1, &copyRegion);
+
+			VkMemoryBarrier hostBarrier{};
+			hostBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &hostBarrier, 0, nullptr, 0, nullptr);
+		}
+
+		void markSubmitted(uint32_t slot) {
+			pendingSlots[slot] = true;
+		}
+
+		// call once the slot's last submission has finished
+		void collect(uint32_t slot) {
+			if (!pendingSlots[slot]) {
+				return;
+			}
+			pendingSlots[slot] = false;
+
+			uint32_t drawn = static_cast<const uint32_t*>(readback.allocation.mapped)[slot];
+			drawnInstances.push(static_cast<double>(drawn));
+			culledInstances.push(static_cast<double>(totalInstances - drawn));
+		}
+
+		GpuCullingSummary summarise() const {
+			GpuCullingSummary summary;
+			summary.drawnInstances = drawnInstances.summarise();
+			summary.culledInstances = culledInstances.summarise();
+
+			return summary;
+		}
+
+	private:
+		// must match local_size_x in cull.comp
+		static const uint32_t CULL_WORKGROUP_SIZE = 64;
+
+		GpuAllocator* allocator = nullptr;
+		VkDevice device = VK_NULL_HANDLE;
+
+		uint32_t totalInstances = 0;
+		uint32_t meshIndexCount = 0;
+		float meshBoundingRadius = 0.0f;
+		PFN_vkCmdDrawIndexedIndirectCountKHR cmdDrawIndexedIndirectCount = nullptr;
+
+		VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+		std::vector<VkDescriptorSet> descriptorSets;
+		std::vector<GpuBuffer> drawCommands;
+		std::vector<GpuBuffer> drawCounts;
+		GpuBuffer readback;
+
+		std::vector<bool> pendingSlots;
+		SampleRing drawnInstances;
+		SampleRing culledInstances;
+};
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <stdexcept>
+
+#include "frame_stats.hpp"
+
+// number of frames kept for percentile summaries
+const size_t PROFILER_HISTORY_LENGTH = 1024;
+
+struct GpuProfilerSummary {
+	PercentileSummary gpuTimeMs;
+	PercentileSummary gpuComputeMs;
+	PercentileSummary cpuFrameTimeMs;
+	PercentileSummary cpuWaitMs;
+	PercentileSummary cpuRecordMs;
+	PercentileSummary vertexInvocations;
+	PercentileSummary fragmentInvocations;
+	PercentileSummary clippingPrimitives;
+};
+
+// records a timestamp pair and pipeline statistics around the work in a command buffer, one query slot per command buffer in flight
+// results are only read back once the slot's previous frame has finished, so reading them never stalls the CPU
+class GpuProfiler {
+	public:
+		void create(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, uint32_t queueFamilyIndex, uint32_t slotCount, bool pipelineStatisticsEnabled) {
+			device = logicalDevice;
+			pendingSlots.assign(slotCount, false);
+
+			VkPhysicalDeviceProperties deviceProperties;
+			vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+			timestampPeriod = deviceProperties.limits.timestampPeriod;
+
+			uint32_t queueFamilyCount = 0;
+			vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+			std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+			vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+			// queues with no valid timestamp bits cannot write timestamps at all
+			uint32_t timestampValidBits = queueFamilies[queueFamilyIndex].timestampValidBits;
+			timestampsSupported = timestampValidBits > 0;
+			timestampMask = timestampValidBits >= 64 ? UINT64_MAX : ((uint64_t(1) << timestampValidBits) - 1);
+			statisticsSupported = pipelineStatisticsEnabled;
+
+			if (timestampsSupported) {
+				VkQueryPoolCreateInfo timestampPoolCreateInfo{};
+				timestampPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+				timestampPoolCreateInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+				timestampPoolCreateInfo.queryCount = slotCount * TIMESTAMPS_PER_SLOT;
+
+				if (vkCreateQueryPool(device, &timestampPoolCreateInfo, nullptr, &timestampPool) != VK_SUCCESS) {
+					throw std::runtime_error("ERROR: Failed to create timestamp query pool");
+				}
+			}
+
+			if (statisticsSupported) {
+				VkQueryPoolCreateInfo statisticsPoolCreateInfo{};
+				statisticsPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+				statisticsPoolCreateInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+				statisticsPoolCreateInfo.queryCount = slotCount;
+				statisticsPoolCreateInfo.pipelineStatistics = getPipelineStatistics();
+
+				if (vkCreateQueryPool(device, &statisticsPoolCreateInfo, nullptr, &statisticsPool) != VK_SUCCESS) {
+					throw std::runtime_error("ERROR: Failed to create pipeline statistics query pool");
+				}
+			}
+		}
+
+		void destroy() {
+			if (timestampPool != VK_NULL_HANDLE) {
+				vkDestroyQueryPool(device, timestampPool, nullptr);
+			}
+			if (statisticsPool != VK_NULL_HANDLE) {
+				vkDestroyQueryPool(device, statisticsPool, nullptr);
+			}
+		}
+
+		// statistics counted by the query cmdBegin leaves active, which secondary command buffers executed inside it must inherit
+		VkQueryPipelineStatisticFlags getPipelineStatistics() const {
+			if (!statisticsSupported) {
+				return 0;
+			}
+
+			return VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT | VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+		}
+
+		// must be recorded outside of a render pass
+		void cmdBegin(VkCommandBuffer commandBuffer, uint32_t slot) {
+			if (timestampsSupported) {
+				vkCmdResetQueryPool(commandBuffer, timestampPool, slot * TIMESTAMPS_PER_SLOT, TIMESTAMPS_PER_SLOT);
+				vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampPool, slot * TIMESTAMPS_PER_SLOT);
+			}
+			if (statisticsSupported) {
+				vkCmdResetQueryPool(commandBuffer, statisticsPool, slot, 1);
+				vkCmdBeginQuery(commandBuffer, statisticsPool, slot, 0);
+			}
+		}
+
+		// must be recorded outside of a render pass
+		void cmdEnd(VkCommandBuffer commandBuffer, uint32_t slot) {
+			if (statisticsSupported) {
+				vkCmdEndQuery(commandBuffer, statisticsPool, slot);
+			}
+			if (timestampsSupported) {
+				vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, timestampPool, slot * TIMESTAMPS_PER_SLOT + 1);
+			}
+		}
+
+		// optional pair of timestamps around the frame's compute work, recorded between cmdBegin and cmdEnd
+		void cmdBeginCompute(VkCommandBuffer commandBuffer, uint32_t slot) {
+			if (timestampsSupported) {
+				vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, timestampPool, slot * TIMESTAMPS_PER_SLOT + 2);
+			}
+		}
+
+		void cmdEndCompute(VkCommandBuffer commandBuffer, uint32_t slot) {
+			if (timestampsSupported) {
+				vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, timestampPool, slot * TIMESTAMPS_PER_SLOT + 3);
+			}
+		}
+
+		void markSubmitted(uint32_t slot) {
+			pendingSlots[slot] = true;
+		}
+
+		// call once the slot's last submission has finished, results which are somehow still unavailable are dropped rather than waited on
+		void collect(uint32_t slot) {
+			if (!pendingSlots[slot]) {
+				return;
+			}
+			pendingSlots[slot] = false;
+
+			if (timestampsSupported) {
+				readTimestampPair(slot * TIMESTAMPS_PER_SLOT, gpuTimeMs);
+				// only available if the frame recorded compute timestamps
+				readTimestampPair(slot * TIMESTAMPS_PER_SLOT + 2, gpuComputeMs);
+			}
+
+			if (statisticsSupported) {
+				// statistics are returned in bit order (vertex invocations, clipping primitives, fragment invocations) followed by availability
+				uint64_t statistics[4];
+				VkResult result = vkGetQueryPoolResults(device, statisticsPool, slot, 1, sizeof(statistics), statistics, sizeof(statistics), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+				if (result == VK_SUCCESS && statistics[3] != 0) {
+					vertexInvocations.push(static_cast<double>(statistics[0]));
+					clippingPrimitives.push(static_cast<double>(statistics[1]));
+					fragmentInvocations.push(static_cast<double>(statistics[2]));
+				}
+			}
+		}
+
+		// wall clock time of a whole iteration of the render loop
+		void recordCpuFrameTime(double milliseconds) {
+			cpuFrameTimeMs.push(milliseconds);
+		}
+
+		// time the CPU spent blocked waiting for the GPU before it could start recording or submitting a frame
+		void recordCpuWait(double milliseconds) {
+			cpuWaitMs.push(milliseconds);
+		}
+
+		// time spent recording the frame's command buffer
+		void recordCpuRecordTime(double milliseconds) {
+			cpuRecordMs.push(milliseconds);
+		}
+
+		bool hasTimestamps() const {
+			return timestampsSupported;
+		}
+
+		bool hasPipelineStatistics() const {
+			return statisticsSupported;
+		}
+
+		GpuProfilerSummary summarise() const {
+			GpuProfilerSummary summary;
+			summary.gpuTimeMs = gpuTimeMs.summarise();
+			summary.gpuComputeMs = gpuComputeMs.summarise();
+			summary.cpuFrameTimeMs = cpuFrameTimeMs.summarise();
+			summary.cpuWaitMs = cpuWaitMs.summarise();
+			summary.cpuRecordMs = cpuRecordMs.summarise();
+			summary.vertexInvocations = vertexInvocations.summarise();
+			summary.fragmentInvocations = fragmentInvocations.summarise();
+			summary.clippingPrimitives = clippingPrimitives.summarise();
+			return summary;
+		}
+
+	private:
+		VkDevice device = VK_NULL_HANDLE;
+		VkQueryPool timestampPool = VK_NULL_HANDLE;
+		VkQueryPool statisticsPool = VK_NULL_HANDLE;
+
+		// frame begin and end, then compute begin and end
+		static const uint32_t TIMESTAMPS_PER_SLOT = 4;
+
+		bool timestampsSupported = false;
+		bool statisticsSupported = false;
+		float timestampPeriod = 1.0f; // nanoseconds per timestamp tick
+		uint64_t timestampMask = UINT64_MAX;
+
+		// whether each slot has been submitted since its results were last read
+		std::vector<bool> pendingSlots;
+
+		SampleRing gpuTimeMs{PROFILER_HISTORY_LENGTH};
+		SampleRing gpuComputeMs{PROFILER_HISTORY_LENGTH};
+		SampleRing cpuFrameTimeMs{PROFILER_HISTORY_LENGTH};
+		SampleRing cpuWaitMs{PROFILER_HISTORY_LENGTH};
+		SampleRing cpuRecordMs{PROFILER_HISTORY_LENGTH};
+		SampleRing vertexInvocations{PROFILER_HISTORY_LENGTH};
+		SampleRing fragmentInvocations{PROFILER_HISTORY_LENGTH};
+		SampleRing clippingPrimitives{PROFILER_HISTORY_LENGTH};
+
+		void readTimestampPair(uint32_t firstQuery, SampleRing& samples) {
+			// each query returns its value followed by its availability, a pair which was never written is simply unavailable
+			uint64_t timestamps[4] = {};
+			vkGetQueryPoolResults(device, timestampPool, firstQuery, 2, sizeof(timestamps), timestamps, 2 * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+			if (timestamps[1] != 0 && timestamps[3] != 0) {
+				uint64_t elapsedTicks = ((timestamps[2] & timestampMask) - (timestamps[0] & timestampMask)) & timestampMask;
+				samples.push(elapsedTicks * timestampPeriod / 1e6);
+			}
+		}
+};
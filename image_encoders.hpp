@@ -0,0 +1,225 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+// a colour attachment read back to host memory, 4 bytes per pixel and tightly packed rows
+struct CapturedImage {
+	const uint8_t* data;
+	uint32_t width;
+	uint32_t height;
+	// B8G8R8A8 rather than R8G8B8A8, as swapchain images usually are
+	bool bgra;
+};
+
+// drops alpha and puts the channels in RGB order
+inline std::vector<uint8_t> toRgb(const CapturedImage& image) {
+	size_t pixelCount = size_t(image.width) * image.height;
+	std::vector<uint8_t> rgb(pixelCount * 3);
+
+	int red = image.bgra ? 2 : 0;
+	int blue = image.bgra ? 0 : 2;
+	for (size_t i = 0; i < pixelCount; i++) {
+		rgb[i * 3] = image.data[i * 4 + red];
+		rgb[i * 3 + 1] = image.data[i * 4 + 1];
+		rgb[i * 3 + 2] = image.data[i * 4 + blue];
+	}
+
+	return rgb;
+}
+
+inline std::ofstream openOutputFile(const std::string& path) {
+	std::ofstream file(path, std::ios::binary);
+	if (!file.is_open()) {
+		throw std::runtime_error("ERROR: Failed to open " + path + " for writing");
+	}
+
+	return file;
+}
+
+// flushed first, so a full disk or I/O error is reported rather than counted as written
+inline void checkOutputFile(std::ofstream& file, const std::string& path) {
+	file.flush();
+	if (!file) {
+		throw std::runtime_error("ERROR: Failed to write " + path);
+	}
+}
+
+// the pixels exactly as read back, with no header
+inline size_t writeRawImage(const std::string& path, const CapturedImage& image) {
+	size_t size = size_t(image.width) * image.height * 4;
+
+	std::ofstream file = openOutputFile(path);
+	file.write(reinterpret_cast<const char*>(image.data), size);
+	checkOutputFile(file, path);
+
+	return size;
+}
+
+inline size_t writePpm(const std::string& path, const CapturedImage& image) {
+	std::vector<uint8_t> rgb = toRgb(image);
+	std::string header = "P6\n" + std::to_string(image.width) + " " + std::to_string(image.height) + "\n255\n";
+
+	std::ofstream file = openOutputFile(path);
+	file.write(header.data(), header.size());
+	file.write(reinterpret_cast<const char*>(rgb.data()), rgb.size());
+	checkOutputFile(file, path);
+
+	return header.size() + rgb.size();
+}
+
+inline uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0) {
+	static const std::vector<uint32_t> table = [] {
+		std::vector<uint32_t> entries(256);
+		for (uint32_t i = 0; i < 256; i++) {
+			uint32_t value = i;
+			for (int bit = 0; bit < 8; bit++) {
+				value = (value & 1) ? 0xedb88320u ^ (value >> 1) : value >> 1;
+			}
+			entries[i] = value;
+		}
+		return entries;
+	}();
+
+	crc = ~crc;
+	for (size_t i = 0; i < size; i++) {
+		crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+	}
+
+	return ~crc;
+}
+
+// PNG with its image data in stored (uncompressed) deflate blocks, so encoding costs little more than a copy
+inline size_t writePng(const std::string& path, const CapturedImage& image) {
+	std::vector<uint8_t> rgb = toRgb(image);
+	size_t rowSize = size_t(image.width) * 3;
+
+	auto appendBigEndian = [](std::vector<uint8_t>& out, uint32_t value) {
+		out.push_back(static_cast<uint8_t>(value >> 24));
+		out.push_back(static_cast<uint8_t>(value >> 16));
+		out.push_back(static_cast<uint8_t>(value >> 8));
+		out.push_back(static_cast<uint8_t>(value));
+	};
+
+	// each scanline is preceded by its filter type, 0 for none
+	std::vector<uint8_t> scanlines;
+	scanlines.reserve((rowSize + 1) * image.height);
+	for (uint32_t row = 0; row < image.height; row++) {
+		scanlines.push_back(0);
+		scanlines.insert(scanlines.end(), rgb.begin() + row * rowSize, rgb.begin() + (row + 1) * rowSize);
+	}
+
+	// zlib stream of stored blocks, each at most 65535 bytes
+	const size_t MAX_STORED_BLOCK = 65535;
+	std::vector<uint8_t> zlib = {0x78, 0x01};
+	zlib.reserve(scanlines.size() + scanlines.size() / MAX_STORED_BLOCK * 5 + 16);
+	for (size_t offset = 0; offset < scanlines.size(); offset += MAX_STORED_BLOCK) {
+		uint16_t blockSize = static_cast<uint16_t>(std::min(MAX_STORED_BLOCK, scanlines.size() - offset));
+		uint16_t invertedSize = static_cast<uint16_t>(~blockSize);
+		bool finalBlock = offset + blockSize >= scanlines.size();
+
+		// block header, then the length and its one's complement, little endian
+		zlib.push_back(finalBlock ? 1 : 0);
+		zlib.push_back(static_cast<uint8_t>(blockSize));
+		zlib.push_back(static_cast<uint8_t>(blockSize >> 8));
+		zlib.push_back(static_cast<uint8_t>(invertedSize));
+		zlib.push_back(static_cast<uint8_t>(invertedSize >> 8));
+		zlib.insert(zlib.end(), scanlines.begin() + offset, scanlines.begin() + offset + blockSize);
+	}
+
+	uint32_t adlerA = 1;
+	uint32_t adlerB = 0;
+	for (uint8_t byte : scanlines) {
+		adlerA = (adlerA + byte) % 65521;
+		adlerB = (adlerB + adlerA) % 65521;
+	}
+	appendBigEndian(zlib, (adlerB << 16) | adlerA);
+
+	std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+	auto appendChunk = [&](const char* type, const std::vector<uint8_t>& data) {
+		appendBigEndian(png, static_cast<uint32_t>(data.size()));
+		size_t typeStart = png.size();
+		png.insert(png.end(), type, type + 4);
+		png.insert(png.end(), data.begin(), data.end());
+		appendBigEndian(png, crc32(png.data() + typeStart, png.size() - typeStart));
+	};
+
+	// 8 bit RGB, default compression and filtering, not interlaced
+	std::vector<uint8_t> header;
+	appendBigEndian(header, image.width);
+	appendBigEndian(header, image.height);
+	header.insert(header.end(), {8, 2, 0, 0, 0});
+
+	appendChunk("IHDR", header);
+	appendChunk("IDAT", zlib);
+	appendChunk("IEND", {});
+
+	std::ofstream file = openOutputFile(path);
+	file.write(reinterpret_cast<const char*>(png.data()), png.size());
+	checkOutputFile(file, path);
+
+	return png.size();
+}
+
+// uncompressed YUV4MPEG2 video in 4:4:4, which players and ffmpeg read directly
+class Y4mWriter {
+	public:
+		void open(const std::string& path, uint32_t videoWidth, uint32_t videoHeight, uint32_t framesPerSecond) {
+			width = videoWidth;
+			height = videoHeight;
+			filePath = path;
+			file = openOutputFile(path);
+
+			std::string header = "YUV4MPEG2 W" + std::to_string(width) + " H" + std::to_string(height) + " F" + std::to_string(framesPerSecond) + ":1 Ip A1:1 C444\n";
+			file.write(header.data(), header.size());
+			checkOutputFile(file, filePath);
+		}
+
+		bool isOpen() const {
+			return file.is_open();
+		}
+
+		size_t writeFrame(const CapturedImage& image) {
+			size_t pixelCount = size_t(width) * height;
+			planes.resize(pixelCount * 3);
+
+			// BT.601 limited range
+			int red = image.bgra ? 2 : 0;
+			int blue = image.bgra ? 0 : 2;
+			for (size_t i = 0; i < pixelCount; i++) {
+				int r = image.data[i * 4 + red];
+				int g = image.data[i * 4 + 1];
+				int b = image.data[i * 4 + blue];
+
+				planes[i] = static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+				planes[pixelCount + i] = static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+				planes[pixelCount * 2 + i] = static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+			}
+
+			const char frameHeader[] = "FRAME\n";
+			file.write(frameHeader, sizeof(frameHeader) - 1);
+			file.write(reinterpret_cast<const char*>(planes.data()), planes.size());
+			checkOutputFile(file, filePath);
+
+			return sizeof(frameHeader) - 1 + planes.size();
+		}
+
+		void close() {
+			if (file.is_open()) {
+				file.close();
+			}
+		}
+
+	private:
+		std::ofstream file;
+		std::string filePath;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		std::vector<uint8_t> planes;
+};
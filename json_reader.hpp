@@ -0,0 +1,290 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstdint>
+
+// just enough JSON to read glTF files, values are parsed into a tree up front
+class JsonValue {
+	public:
+		enum class Type {
+			Null,
+			Bool,
+			Number,
+			String,
+			Array,
+			Object
+		};
+
+		static JsonValue parse(const std::string& text) {
+			size_t position = 0;
+			JsonValue value = parseValue(text, position);
+
+			skipWhitespace(text, position);
+			if (position != text.size()) {
+				throw std::runtime_error("ERROR: Unexpected trailing characters in JSON");
+			}
+
+			return value;
+		}
+
+		Type getType() const {
+			return type;
+		}
+
+		bool isNull() const {
+			return type == Type::Null;
+		}
+
+		double asNumber() const {
+			if (type != Type::Number) {
+				throw std::runtime_error("ERROR: JSON value is not a number");
+			}
+			return number;
+		}
+
+		uint64_t asIndex() const {
+			double value = asNumber();
+			if (value < 0.0 || value != static_cast<double>(static_cast<uint64_t>(value))) {
+				throw std::runtime_error("ERROR: JSON value is not an index");
+			}
+			return static_cast<uint64_t>(value);
+		}
+
+		bool asBool() const {
+			if (type != Type::Bool) {
+				throw std::runtime_error("ERROR: JSON value is not a boolean");
+			}
+			return boolean;
+		}
+
+		const std::string& asString() const {
+			if (type != Type::String) {
+				throw std::runtime_error("ERROR: JSON value is not a string");
+			}
+			return string;
+		}
+
+		// number of elements of an array, or members of an object
+		size_t size() const {
+			return type == Type::Array ? array.size() : object.size();
+		}
+
+		const JsonValue& operator[](size_t index) const {
+			if (type != Type::Array || index >= array.size()) {
+				throw std::runtime_error("ERROR: JSON array index out of range");
+			}
+			return array[index];
+		}
+
+		// nullptr if this is not an object or has no such member
+		const JsonValue* find(const std::string& key) const {
+			for (const auto& member : object) {
+				if (member.first == key) {
+					return &member.second;
+				}
+			}
+			return nullptr;
+		}
+
+		const JsonValue& operator[](const std::string& key) const {
+			const JsonValue* value = find(key);
+			if (value == nullptr) {
+				throw std::runtime_error("ERROR: JSON object has no member " + key);
+			}
+			return *value;
+		}
+
+		double numberOr(const std::string& key, double fallback) const {
+			const JsonValue* value = find(key);
+			return value != nullptr ? value->asNumber() : fallback;
+		}
+
+	private:
+		Type type = Type::Null;
+		bool boolean = false;
+		double number = 0.0;
+		std::string string;
+		std::vector<JsonValue> array;
+		std::vector<std::pair<std::string, JsonValue>> object;
+
+		static void skipWhitespace(const std::string& text, size_t& position) {
+			while (position < text.size() && (text[position] == ' ' || text[position] == '\t' || text[position] == '\n' || text[position] == '\r')) {
+				position++;
+			}
+		}
+
+		static void expect(const std::string& text, size_t& position, const char* literal) {
+			for (const char* c = literal; *c != '\0'; c++, position++) {
+				if (position >= text.size() || text[position] != *c) {
+					throw std::runtime_error("ERROR: Malformed JSON");
+				}
+			}
+		}
+
+		static JsonValue parseValue(const std::string& text, size_t& position) {
+			skipWhitespace(text, position);
+			if (position >= text.size()) {
+				throw std::runtime_error("ERROR: Unexpected end of JSON");
+			}
+
+			JsonValue value;
+			char c = text[position];
+
+			if (c == '{') {
+				value.type = Type::Object;
+				position++;
+				skipWhitespace(text, position);
+				if (position < text.size() && text[position] == '}') {
+					position++;
+					return value;
+				}
+				while (true) {
+					skipWhitespace(text, position);
+					std::string key = parseString(text, position);
+					skipWhitespace(text, position);
+					expect(text, position, ":");
+					value.object.emplace_back(std::move(key), parseValue(text, position));
+
+					skipWhitespace(text, position);
+					if (position < text.size() && text[position] == ',') {
+						position++;
+						continue;
+					}
+					expect(text, position, "}");
+					return value;
+				}
+			}
+			else if (c == '[') {
+				value.type = Type::Array;
+				position++;
+				skipWhitespace(text, position);
+				if (position < text.size() && text[position] == ']') {
+					position++;
+					return value;
+				}
+				while (true) {
+					value.array.push_back(parseValue(text, position));
+
+					skipWhitespace(text, position);
+					if (position < text.size() && text[position] == ',') {
+						position++;
+						continue;
+					}
+					expect(text, position, "]");
+					return value;
+				}
+			}
+			else if (c == '"') {
+				value.type = Type::String;
+				value.string = parseString(text, position);
+			}
+			else if (c == 't') {
+				expect(text, position, "true");
+				value.type = Type::Bool;
+				value.boolean = true;
+			}
+			else if (c == 'f') {
+				expect(text, position, "false");
+				value.type = Type::Bool;
+			}
+			else if (c == 'n') {
+				expect(text, position, "null");
+			}
+			else {
+				const char* start = text.c_str() + position;
+				char* end;
+				value.number = std::strtod(start, &end);
+				if (end == start) {
+					throw std::runtime_error("ERROR: Malformed JSON");
+				}
+				value.type = Type::Number;
+				position += end - start;
+			}
+
+			return value;
+		}
+
+		static void appendUtf8(std::string& out, uint32_t codePoint) {
+			if (codePoint < 0x80) {
+				out += static_cast<char>(codePoint);
+			}
+			else if (codePoint < 0x800) {
+				out += static_cast<char>(0xc0 | (codePoint >> 6));
+				out += static_cast<char>(0x80 | (codePoint & 0x3f));
+			}
+			else if (codePoint < 0x10000) {
+				out += static_cast<char>(0xe0 | (codePoint >> 12));
+				out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+				out += static_cast<char>(0x80 | (codePoint & 0x3f));
+			}
+			else {
+				out += static_cast<char>(0xf0 | (codePoint >> 18));
+				out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f));
+				out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+				out += static_cast<char>(0x80 | (codePoint & 0x3f));
+			}
+		}
+
+		static uint32_t parseHex4(const std::string& text, size_t& position) {
+			if (position + 4 > text.size()) {
+				throw std::runtime_error("ERROR: Malformed JSON escape");
+			}
+			uint32_t value = static_cast<uint32_t>(std::stoul(text.substr(position, 4), nullptr, 16));
+			position += 4;
+			return value;
+		}
+
+		static std::string parseString(const std::string& text, size_t& position) {
+			expect(text, position, "\"");
+
+			std::string result;
+			while (position < text.size() && text[position] != '"') {
+				char c = text[position++];
+				if (c != '\\') {
+					result += c;
+					continue;
+				}
+
+				if (position >= text.size()) {
+					break;
+				}
+				char escape = text[position++];
+				if (escape == 'b') {
+					result += '\b';
+				}
+				else if (escape == 'f') {
+					result += '\f';
+				}
+				else if (escape == 'n') {
+					result += '\n';
+				}
+				else if (escape == 'r') {
+					result += '\r';
+				}
+				else if (escape == 't') {
+					result += '\t';
+				}
+				else if (escape == 'u') {
+					uint32_t codePoint = parseHex4(text, position);
+					// characters outside the basic plane are escaped as a surrogate pair
+					if (codePoint >= 0xd800 && codePoint < 0xdc00 && position + 6 <= text.size() && text[position] == '\\' && text[position + 1] == 'u') {
+						position += 2;
+						uint32_t low = parseHex4(text, position);
+						codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (low - 0xdc00);
+					}
+					appendUtf8(result, codePoint);
+				}
+				else {
+					// quotes, backslashes and slashes stand for themselves
+					result += escape;
+				}
+			}
+
+			expect(text, position, "\"");
+			return result;
+		}
+};
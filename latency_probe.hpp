@@ -0,0 +1,85 @@
+#pragma once
+
+#include <deque>
+#include <chrono>
+#include <cstdint>
+
+#include "frame_stats.hpp"
+
+struct LatencySummary {
+	PercentileSummary inputToSubmitMs;
+	PercentileSummary submitToPresentMs;
+	PercentileSummary inputToPresentMs;
+	// frames whose presentation was never observed, e.g. because the swapchain was recreated first
+	uint64_t droppedFrames = 0;
+};
+
+// timestamps each frame when its input is sampled, when it is submitted and when its presentation completes
+// frames are identified by an id which increases by one per submitted frame, and complete in submission order
+class LatencyProbe {
+	public:
+		// called right after input has been polled for the frame, again for the same id if the frame had to be retried
+		void sampleInput(uint64_t frameId) {
+			auto now = std::chrono::steady_clock::now();
+
+			if (!pending.empty() && pending.back().id == frameId) {
+				pending.back().input = now;
+			}
+			else {
+				pending.push_back({frameId, now, now, false});
+			}
+		}
+
+		void markSubmitted(uint64_t frameId) {
+			if (!pending.empty() && pending.back().id == frameId) {
+				pending.back().submit = std::chrono::steady_clock::now();
+				pending.back().submitted = true;
+			}
+		}
+
+		// frameId and every frame submitted before it have completed presentation
+		void markPresented(uint64_t frameId) {
+			auto now = std::chrono::steady_clock::now();
+
+			while (!pending.empty() && pending.front().id <= frameId && pending.front().submitted) {
+				const PendingFrame& frame = pending.front();
+				inputToSubmitMs.push(std::chrono::duration<double, std::milli>(frame.submit - frame.input).count());
+				submitToPresentMs.push(std::chrono::duration<double, std::milli>(now - frame.submit).count());
+				inputToPresentMs.push(std::chrono::duration<double, std::milli>(now - frame.input).count());
+				pending.pop_front();
+			}
+		}
+
+		// forgets submitted frames whose completion can no longer be observed
+		void discardPending() {
+			while (!pending.empty() && pending.front().submitted) {
+				pending.pop_front();
+				droppedFrames++;
+			}
+		}
+
+		LatencySummary summarise() const {
+			LatencySummary summary;
+			summary.inputToSubmitMs = inputToSubmitMs.summarise();
+			summary.submitToPresentMs = submitToPresentMs.summarise();
+			summary.inputToPresentMs = inputToPresentMs.summarise();
+			summary.droppedFrames = droppedFrames;
+
+			return summary;
+		}
+
+	private:
+		struct PendingFrame {
+			uint64_t id;
+			std::chrono::steady_clock::time_point input;
+			std::chrono::steady_clock::time_point submit;
+			bool submitted;
+		};
+
+		std::deque<PendingFrame> pending;
+		uint64_t droppedFrames = 0;
+
+		SampleRing inputToSubmitMs;
+		SampleRing submitToPresentMs;
+		SampleRing inputToPresentMs;
+};
@@ -0,0 +1,41 @@
+#include "mesh_file.hpp"
+#include "mesh_import.hpp"
+#include "mesh_optimizer.hpp"
+
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+// converts a mesh to the binary format VulkanTriangle maps with --mesh, so text is parsed and the mesh optimised once rather than at every startup
+
+int main(int argc, char* argv[]) {
+	if (argc != 3) {
+		std::cerr << "Usage: " << argv[0] << " INPUT.obj|INPUT.gltf|INPUT.glb OUTPUT.vtmesh" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	try {
+		auto start = std::chrono::steady_clock::now();
+
+		WorkerPool pool;
+		pool.start(std::max(1u, std::thread::hardware_concurrency()));
+
+		MeshImportStats importStats;
+		Mesh mesh = importMesh(argv[1], pool, importStats);
+		MeshOptimizationStats optimizationStats = optimizeMesh(mesh);
+		uint64_t bytesWritten = writeMeshFile(argv[2], mesh);
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		const double MiB = 1024.0 * 1024.0;
+
+		std::cout << "Imported " << argv[1] << " on " << importStats.threads << " threads: parse " << importStats.parseMs << " ms, " << importStats.sourceVertices << " vertices deduplicated to " << mesh.vertices.size() << " in " << importStats.deduplicateMs << " ms, peak memory " << importStats.peakMemoryBytes / MiB << " MiB" << std::endl;
+		std::cout << "Optimised in " << optimizationStats.optimizeMs << " ms, vertex cache (" << VERTEX_CACHE_SIZE << " entries): ACMR " << optimizationStats.before.acmr << " -> " << optimizationStats.after.acmr << ", ATVR " << optimizationStats.before.atvr << " -> " << optimizationStats.after.atvr << std::endl;
+		std::cout << "Wrote " << mesh.vertices.size() << " vertices and " << mesh.indices.size() << " indices to " << argv[2] << " (" << bytesWritten << " bytes) in " << seconds << " s" << std::endl;
+	}
+	catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <string>
+#include <fstream>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+#include "geometry.hpp"
+
+// binary mesh container, a header followed by the vertex and index streams exactly as the vertex and index buffers hold them
+// the streams start on page boundaries, so a mapping of the file can be copied from (or imported) without any realignment
+const char MESH_FILE_MAGIC[8] = {'V', 'T', 'M', 'E', 'S', 'H', '\0', '\0'};
+const uint32_t MESH_FILE_VERSION = 1;
+const uint64_t MESH_FILE_ALIGNMENT = 4096;
+
+// all fields little endian, as written by the converter
+struct MeshFileHeader {
+	char magic[8];
+	uint32_t version;
+	// sizeof(Vertex) when the file was written, files with another vertex layout have to be converted again
+	uint32_t vertexStride;
+	uint64_t vertexCount;
+	// 32 bit indices
+	uint64_t indexCount;
+	// byte offsets of the streams from the start of the file
+	uint64_t vertexOffset;
+	uint64_t indexOffset;
+	// furthest any vertex lies from the origin in the view plane, so loading never has to scan the vertices
+	float boundingRadius;
+	uint32_t reserved;
+};
+
+static_assert(sizeof(MeshFileHeader) == 56, "MeshFileHeader is read straight from the file");
+
+inline uint64_t alignMeshFileOffset(uint64_t offset) {
+	return (offset + MESH_FILE_ALIGNMENT - 1) / MESH_FILE_ALIGNMENT * MESH_FILE_ALIGNMENT;
+}
+
+// returns the number of bytes written
+inline uint64_t writeMeshFile(const std::string& path, const Mesh& mesh) {
+	MeshFileHeader header{};
+	std::memcpy(header.magic, MESH_FILE_MAGIC, sizeof(header.magic));
+	header.version = MESH_FILE_VERSION;
+	header.vertexStride = sizeof(Vertex);
+	header.vertexCount = mesh.vertices.size();
+	header.indexCount = mesh.indices.size();
+	header.vertexOffset = alignMeshFileOffset(sizeof(MeshFileHeader));
+	header.indexOffset = alignMeshFileOffset(header.vertexOffset + sizeof(Vertex) * mesh.vertices.size());
+	header.boundingRadius = meshBoundingRadius(mesh);
+
+	std::ofstream file(path, std::ios::binary);
+	if (!file.is_open()) {
+		throw std::runtime_error("ERROR: Failed to open " + path + " for writing");
+	}
+
+	uint64_t fileSize = header.indexOffset + sizeof(uint32_t) * mesh.indices.size();
+
+	const char padding[MESH_FILE_ALIGNMENT] = {};
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(padding, header.vertexOffset - sizeof(header));
+	file.write(reinterpret_cast<const char*>(mesh.vertices.data()), sizeof(Vertex) * mesh.vertices.size());
+	file.write(padding, header.indexOffset - header.vertexOffset - sizeof(Vertex) * mesh.vertices.size());
+	file.write(reinterpret_cast<const char*>(mesh.indices.data()), sizeof(uint32_t) * mesh.indices.size());
+
+	if (!file) {
+		throw std::runtime_error("ERROR: Failed to write " + path);
+	}
+
+	return fileSize;
+}
+
+// a mesh file mapped read-only, its streams are used in place rather than read into heap memory
+class MappedMeshFile {
+	public:
+		MappedMeshFile() = default;
+		MappedMeshFile(const MappedMeshFile&) = delete;
+		MappedMeshFile& operator=(const MappedMeshFile&) = delete;
+
+		~MappedMeshFile() {
+			close();
+		}
+
+		void open(const std::string& path) {
+			int descriptor = ::open(path.c_str(), O_RDONLY);
+			if (descriptor < 0) {
+				throw std::runtime_error("ERROR: Failed to open mesh file " + path);
+			}
+
+			struct stat fileStatus;
+			if (fstat(descriptor, &fileStatus) != 0 || static_cast<size_t>(fileStatus.st_size) < sizeof(MeshFileHeader)) {
+				::close(descriptor);
+				throw std::runtime_error("ERROR: " + path + " is too small to be a mesh file");
+			}
+			size = static_cast<size_t>(fileStatus.st_size);
+
+			// the mapping holds its own reference to the file, so the descriptor is not needed past this point
+			void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+			::close(descriptor);
+			if (mapping == MAP_FAILED) {
+				throw std::runtime_error("ERROR: Failed to map mesh file " + path);
+			}
+			data = static_cast<const uint8_t*>(mapping);
+
+			// the upload reads the streams once from front to back, so ask for aggressive readahead
+			madvise(mapping, size, MADV_SEQUENTIAL);
+			madvise(mapping, size, MADV_WILLNEED);
+
+			try {
+				validate(path);
+			}
+			catch (...) {
+				close();
+				throw;
+			}
+		}
+
+		void close() {
+			if (data != nullptr) {
+				munmap(const_cast<uint8_t*>(data), size);
+				data = nullptr;
+				size = 0;
+			}
+		}
+
+		const MeshFileHeader& getHeader() const {
+			return *reinterpret_cast<const MeshFileHeader*>(data);
+		}
+
+		const Vertex* getVertices() const {
+			return reinterpret_cast<const Vertex*>(data + getHeader().vertexOffset);
+		}
+
+		const uint32_t* getIndices() const {
+			return reinterpret_cast<const uint32_t*>(data + getHeader().indexOffset);
+		}
+
+		uint64_t getVertexBytes() const {
+			return getHeader().vertexCount * sizeof(Vertex);
+		}
+
+		uint64_t getIndexBytes() const {
+			return getHeader().indexCount * sizeof(uint32_t);
+		}
+
+		size_t getFileSize() const {
+			return size;
+		}
+
+	private:
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+
+		void validate(const std::string& path) const {
+			const MeshFileHeader& header = getHeader();
+
+			if (std::memcmp(header.magic, MESH_FILE_MAGIC, sizeof(header.magic)) != 0) {
+				throw std::runtime_error("ERROR: " + path + " is not a mesh file");
+			}
+			if (header.version != MESH_FILE_VERSION || header.vertexStride != sizeof(Vertex)) {
+				throw std::runtime_error("ERROR: " + path + " was written for a different mesh format version or vertex layout, convert it again");
+			}
+			if (header.vertexOffset % MESH_FILE_ALIGNMENT != 0 || header.indexOffset % MESH_FILE_ALIGNMENT != 0) {
+				throw std::runtime_error("ERROR: " + path + " has misaligned streams");
+			}
+			// compared as counts rather than byte sizes, so a corrupt count cannot overflow the check
+			if (header.vertexOffset > size || header.vertexCount > (size - header.vertexOffset) / sizeof(Vertex) || header.indexOffset > size || header.indexCount > (size - header.indexOffset) / sizeof(uint32_t)) {
+				throw std::runtime_error("ERROR: " + path + " is truncated");
+			}
+			if (header.vertexCount == 0 || header.indexCount == 0) {
+				throw std::runtime_error("ERROR: " + path + " has no geometry");
+			}
+			// both counts fit the file by now, so the stream ends cannot overflow
+			uint64_t vertexEnd = header.vertexOffset + header.vertexCount * sizeof(Vertex);
+			uint64_t indexEnd = header.indexOffset + header.indexCount * sizeof(uint32_t);
+			if (header.vertexOffset < sizeof(MeshFileHeader) || header.indexOffset < sizeof(MeshFileHeader) || (header.vertexOffset < indexEnd && header.indexOffset < vertexEnd)) {
+				throw std::runtime_error("ERROR: " + path + " has streams overlapping the header or each other");
+			}
+			if (header.vertexCount > UINT32_MAX || header.indexCount > UINT32_MAX) {
+				throw std::runtime_error("ERROR: " + path + " has more vertices or indices than one 32 bit indexed draw can use");
+			}
+		}
+};
@@ -0,0 +1,882 @@
+#pragma once
+
+#include <sys/resource.h>
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <cctype>
+
+#include "geometry.hpp"
+#include "json_reader.hpp"
+#include "worker_pool.hpp"
+
+struct MeshImportStats {
+	// vertices as read, one per face corner for OBJ, before identical ones are merged
+	uint64_t sourceVertices = 0;
+	uint32_t threads = 0;
+	// reading and parsing the file
+	double parseMs = 0.0;
+	// merging identical vertices and building the index buffer
+	double deduplicateMs = 0.0;
+	// peak resident memory of the whole process once the import has finished
+	uint64_t peakMemoryBytes = 0;
+};
+
+inline uint64_t peakResidentBytes() {
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return 0;
+	}
+
+	// kilobytes on Linux
+	return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+}
+
+// the vertex layout has no normal, so meshes which have them are coloured by them instead, which shows their shape without lighting
+inline void colourFromNormal(const float* normal, float* colour) {
+	float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+	float scale = length > 0.0f ? 0.5f / length : 0.0f;
+
+	for (int axis = 0; axis < 3; axis++) {
+		colour[axis] = 0.5f + normal[axis] * scale;
+	}
+}
+
+static_assert(sizeof(Vertex) % sizeof(uint32_t) == 0, "vertices are hashed and compared a word at a time");
+
+// merges identical vertices into one as they are added, returning the index of each
+// open addressing over the vertices' contents, far cheaper per lookup than std::unordered_map for the tens of millions of vertices of large models
+class VertexDeduplicator {
+	public:
+		VertexDeduplicator(std::vector<Vertex>& uniqueVertices, size_t expectedVertices) : vertices(uniqueVertices) {
+			size_t tableSize = 16;
+			while (tableSize < expectedVertices * 2) {
+				tableSize *= 2;
+			}
+			table.assign(tableSize, EMPTY);
+		}
+
+		uint32_t add(const Vertex& vertex) {
+			// kept at most half full, so probe sequences stay short
+			if ((vertices.size() + 1) * 2 > table.size()) {
+				grow();
+			}
+
+			size_t mask = table.size() - 1;
+			for (size_t slot = hash(vertex) & mask;; slot = (slot + 1) & mask) {
+				uint32_t entry = table[slot];
+				if (entry == EMPTY) {
+					table[slot] = static_cast<uint32_t>(vertices.size());
+					vertices.push_back(vertex);
+					return table[slot];
+				}
+				if (std::memcmp(&vertices[entry], &vertex, sizeof(Vertex)) == 0) {
+					return entry;
+				}
+			}
+		}
+
+	private:
+		static constexpr uint32_t EMPTY = UINT32_MAX;
+
+		std::vector<Vertex>& vertices;
+		std::vector<uint32_t> table;
+
+		static size_t hash(const Vertex& vertex) {
+			uint32_t words[sizeof(Vertex) / sizeof(uint32_t)];
+			std::memcpy(words, &vertex, sizeof(Vertex));
+
+			// FNV-1a over words rather than bytes, then the high bits folded in as the table only uses the low ones
+			uint64_t value = 14695981039346656037ull;
+			for (uint32_t word : words) {
+				value = (value ^ word) * 1099511628211ull;
+			}
+
+			return static_cast<size_t>(value ^ (value >> 32));
+		}
+
+		void grow() {
+			table.assign(table.size() * 2, EMPTY);
+
+			size_t mask = table.size() - 1;
+			for (uint32_t i = 0; i < vertices.size(); i++) {
+				size_t slot = hash(vertices[i]) & mask;
+				while (table[slot] != EMPTY) {
+					slot = (slot + 1) & mask;
+				}
+				table[slot] = i;
+			}
+		}
+};
+
+inline std::string readWholeFile(const std::string& path) {
+	std::ifstream file(path, std::ios::ate | std::ios::binary);
+	if (!file.is_open()) {
+		throw std::runtime_error("ERROR: Failed to open " + path);
+	}
+
+	std::string contents(static_cast<size_t>(file.tellg()), '\0');
+	file.seekg(0);
+	file.read(&contents[0], contents.size());
+
+	return contents;
+}
+
+// a face corner's indices as written, relative ones are resolved once every chunk's counts are known
+struct ObjCorner {
+	int64_t position;
+	int64_t normal;
+	uint8_t flags;
+};
+
+const uint8_t OBJ_POSITION_RELATIVE = 1;
+const uint8_t OBJ_NORMAL_RELATIVE = 2;
+const uint8_t OBJ_HAS_NORMAL = 4;
+
+// what one thread parsed from its range of lines
+struct ObjChunk {
+	std::vector<float> positions;
+	std::vector<float> colours;
+	std::vector<float> normals;
+	// three per triangle, polygons are already triangulated as fans
+	std::vector<ObjCorner> corners;
+	std::vector<Vertex> vertices;
+};
+
+inline const char* skipObjSpaces(const char* cursor, const char* end) {
+	while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r')) {
+		cursor++;
+	}
+	return cursor;
+}
+
+inline bool startsObjNumber(const char* cursor, const char* end) {
+	return cursor < end && ((*cursor >= '0' && *cursor <= '9') || *cursor == '-' || *cursor == '+' || *cursor == '.');
+}
+
+// reads up to count floats from the line, returning how many were there
+inline int parseObjFloats(const char*& cursor, const char* end, float* values, int count) {
+	int parsed = 0;
+	while (parsed < count) {
+		cursor = skipObjSpaces(cursor, end);
+		if (!startsObjNumber(cursor, end)) {
+			break;
+		}
+
+		char* numberEnd;
+		values[parsed++] = std::strtof(cursor, &numberEnd);
+		cursor = numberEnd;
+	}
+	return parsed;
+}
+
+inline void parseObjChunk(const char* begin, const char* end, ObjChunk& chunk) {
+	std::vector<ObjCorner> face;
+
+	for (const char* line = begin; line < end;) {
+		const char* lineEnd = static_cast<const char*>(std::memchr(line, '\n', end - line));
+		if (lineEnd == nullptr) {
+			lineEnd = end;
+		}
+
+		const char* cursor = skipObjSpaces(line, lineEnd);
+		bool isVertex = lineEnd - cursor > 1 && cursor[0] == 'v' && (cursor[1] == ' ' || cursor[1] == '\t');
+		bool isNormal = lineEnd - cursor > 2 && cursor[0] == 'v' && cursor[1] == 'n' && (cursor[2] == ' ' || cursor[2] == '\t');
+		bool isFace = lineEnd - cursor > 1 && cursor[0] == 'f' && (cursor[1] == ' ' || cursor[1] == '\t');
+
+		if (isVertex) {
+			cursor += 1;
+			// positions may be followed by a colour, a widespread extension
+			float values[6] = {0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f};
+			if (parseObjFloats(cursor, lineEnd, values, 6) < 6) {
+				values[3] = values[4] = values[5] = 1.0f;
+			}
+			chunk.positions.insert(chunk.positions.end(), values, values + 3);
+			chunk.colours.insert(chunk.colours.end(), values + 3, values + 6);
+		}
+		else if (isNormal) {
+			cursor += 2;
+			float values[3] = {0.0f, 0.0f, 0.0f};
+			parseObjFloats(cursor, lineEnd, values, 3);
+			chunk.normals.insert(chunk.normals.end(), values, values + 3);
+		}
+		else if (isFace) {
+			cursor += 1;
+			face.clear();
+
+			// each corner is v, v/vt, v//vn or v/vt/vn
+			while (true) {
+				cursor = skipObjSpaces(cursor, lineEnd);
+				if (!startsObjNumber(cursor, lineEnd)) {
+					break;
+				}
+
+				ObjCorner corner = {0, 0, 0};
+				char* numberEnd;
+				long position = std::strtol(cursor, &numberEnd, 10);
+				cursor = numberEnd;
+
+				// negative indices count back from the latest position, so are kept relative to this chunk's count until its start is known
+				corner.position = position < 0 ? static_cast<int64_t>(chunk.positions.size() / 3) + position : position - 1;
+				corner.flags |= position < 0 ? OBJ_POSITION_RELATIVE : 0;
+
+				if (cursor < lineEnd && *cursor == '/') {
+					cursor++;
+					if (startsObjNumber(cursor, lineEnd)) {
+						std::strtol(cursor, &numberEnd, 10);
+						cursor = numberEnd;
+					}
+					if (cursor < lineEnd && *cursor == '/') {
+						cursor++;
+						if (startsObjNumber(cursor, lineEnd)) {
+							long normal = std::strtol(cursor, &numberEnd, 10);
+							cursor = numberEnd;
+							corner.normal = normal < 0 ? static_cast<int64_t>(chunk.normals.size() / 3) + normal : normal - 1;
+							corner.flags |= OBJ_HAS_NORMAL | (normal < 0 ? OBJ_NORMAL_RELATIVE : 0);
+						}
+					}
+				}
+
+				face.push_back(corner);
+			}
+
+			for (size_t i = 2; i < face.size(); i++) {
+				chunk.corners.push_back(face[0]);
+				chunk.corners.push_back(face[i - 1]);
+				chunk.corners.push_back(face[i]);
+			}
+		}
+
+		line = lineEnd + 1;
+	}
+}
+
+// parses on every thread of the pool, each taking a range of whole lines, then merges identical corners into indexed vertices
+inline Mesh importObj(const std::string& path, WorkerPool& pool, MeshImportStats& stats) {
+	auto parseStart = std::chrono::steady_clock::now();
+
+	std::string text = readWholeFile(path);
+	uint32_t threadCount = pool.getThreadCount();
+
+	// chunk boundaries are moved forward to the next line start
+	std::vector<size_t> boundaries(threadCount + 1, text.size());
+	boundaries[0] = 0;
+	for (uint32_t i = 1; i < threadCount; i++) {
+		size_t boundary = std::max(boundaries[i - 1], text.size() * i / threadCount);
+		size_t lineEnd = text.find('\n', boundary);
+		boundaries[i] = lineEnd == std::string::npos ? text.size() : lineEnd + 1;
+	}
+
+	std::vector<ObjChunk> chunks(threadCount);
+	pool.run([&](uint32_t i) {
+		parseObjChunk(text.data() + boundaries[i], text.data() + boundaries[i + 1], chunks[i]);
+	});
+
+	// where each chunk's positions and normals start among the whole file's
+	std::vector<int64_t> positionStarts(threadCount + 1, 0);
+	std::vector<int64_t> normalStarts(threadCount + 1, 0);
+	for (uint32_t i = 0; i < threadCount; i++) {
+		positionStarts[i + 1] = positionStarts[i] + static_cast<int64_t>(chunks[i].positions.size() / 3);
+		normalStarts[i + 1] = normalStarts[i] + static_cast<int64_t>(chunks[i].normals.size() / 3);
+	}
+
+	// positions and normals may be defined in any chunk, so each thread resolves its corners against all of them
+	pool.run([&](uint32_t i) {
+		ObjChunk& chunk = chunks[i];
+		chunk.vertices.resize(chunk.corners.size());
+
+		for (size_t c = 0; c < chunk.corners.size(); c++) {
+			const ObjCorner& corner = chunk.corners[c];
+
+			int64_t position = corner.position + ((corner.flags & OBJ_POSITION_RELATIVE) ? positionStarts[i] : 0);
+			if (position < 0 || position >= positionStarts[threadCount]) {
+				throw std::runtime_error("ERROR: " + path + " has a face referring to a missing vertex");
+			}
+
+			size_t owner = std::upper_bound(positionStarts.begin(), positionStarts.end(), position) - positionStarts.begin() - 1;
+			size_t local = static_cast<size_t>(position - positionStarts[owner]);
+
+			Vertex& vertex = chunk.vertices[c];
+			std::memcpy(vertex.position, &chunks[owner].positions[local * 3], sizeof(vertex.position));
+			std::memcpy(vertex.colour, &chunks[owner].colours[local * 3], sizeof(vertex.colour));
+
+			if (corner.flags & OBJ_HAS_NORMAL) {
+				int64_t normal = corner.normal + ((corner.flags & OBJ_NORMAL_RELATIVE) ? normalStarts[i] : 0);
+				if (normal < 0 || normal >= normalStarts[threadCount]) {
+					throw std::runtime_error("ERROR: " + path + " has a face referring to a missing normal");
+				}
+
+				size_t normalOwner = std::upper_bound(normalStarts.begin(), normalStarts.end(), normal) - normalStarts.begin() - 1;
+				colourFromNormal(&chunks[normalOwner].normals[static_cast<size_t>(normal - normalStarts[normalOwner]) * 3], vertex.colour);
+			}
+		}
+	});
+
+	auto deduplicateStart = std::chrono::steady_clock::now();
+
+	Mesh mesh;
+	size_t cornerCount = 0;
+	for (const auto& chunk : chunks) {
+		cornerCount += chunk.corners.size();
+	}
+	mesh.indices.reserve(cornerCount);
+
+	VertexDeduplicator deduplicator(mesh.vertices, static_cast<size_t>(positionStarts[threadCount]));
+	for (auto& chunk : chunks) {
+		for (const Vertex& vertex : chunk.vertices) {
+			mesh.indices.push_back(deduplicator.add(vertex));
+		}
+		chunk = ObjChunk();
+	}
+
+	if (mesh.indices.empty()) {
+		throw std::runtime_error("ERROR: " + path + " has no faces");
+	}
+
+	stats.sourceVertices = cornerCount;
+	stats.parseMs = std::chrono::duration<double, std::milli>(deduplicateStart - parseStart).count();
+	stats.deduplicateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - deduplicateStart).count();
+
+	return mesh;
+}
+
+inline std::string decodeBase64(const std::string& text, size_t start) {
+	auto value = [](char c) -> int {
+		if (c >= 'A' && c <= 'Z') {
+			return c - 'A';
+		}
+		if (c >= 'a' && c <= 'z') {
+			return c - 'a' + 26;
+		}
+		if (c >= '0' && c <= '9') {
+			return c - '0' + 52;
+		}
+		if (c == '+') {
+			return 62;
+		}
+		if (c == '/') {
+			return 63;
+		}
+		return -1;
+	};
+
+	std::string decoded;
+	decoded.reserve((text.size() - start) / 4 * 3);
+
+	uint32_t bits = 0;
+	int bitCount = 0;
+	for (size_t i = start; i < text.size(); i++) {
+		int digit = value(text[i]);
+		if (digit < 0) {
+			// padding
+			break;
+		}
+
+		bits = (bits << 6) | static_cast<uint32_t>(digit);
+		bitCount += 6;
+		if (bitCount >= 8) {
+			bitCount -= 8;
+			decoded += static_cast<char>((bits >> bitCount) & 0xff);
+		}
+	}
+
+	return decoded;
+}
+
+// column major 4x4 matrices, as glTF stores them
+inline void multiplyMatrices(const float* a, const float* b, float* result) {
+	float product[16];
+	for (int column = 0; column < 4; column++) {
+		for (int row = 0; row < 4; row++) {
+			product[column * 4 + row] = 0.0f;
+			for (int k = 0; k < 4; k++) {
+				product[column * 4 + row] += a[k * 4 + row] * b[column * 4 + k];
+			}
+		}
+	}
+	std::memcpy(result, product, sizeof(product));
+}
+
+inline void nodeMatrix(const JsonValue& node, float* matrix) {
+	if (const JsonValue* values = node.find("matrix")) {
+		for (int i = 0; i < 16; i++) {
+			matrix[i] = static_cast<float>((*values)[i].asNumber());
+		}
+		return;
+	}
+
+	float t[3] = {0.0f, 0.0f, 0.0f};
+	float r[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+	float s[3] = {1.0f, 1.0f, 1.0f};
+	if (const JsonValue* values = node.find("translation")) {
+		for (int i = 0; i < 3; i++) {
+			t[i] = static_cast<float>((*values)[i].asNumber());
+		}
+	}
+	if (const JsonValue* values = node.find("rotation")) {
+		for (int i = 0; i < 4; i++) {
+			r[i] = static_cast<float>((*values)[i].asNumber());
+		}
+	}
+	if (const JsonValue* values = node.find("scale")) {
+		for (int i = 0; i < 3; i++) {
+			s[i] = static_cast<float>((*values)[i].asNumber());
+		}
+	}
+
+	// translation * rotation * scale, the rotation being the unit quaternion (x, y, z, w)
+	float x = r[0], y = r[1], z = r[2], w = r[3];
+	float rotation[9] = {
+		1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + z * w), 2.0f * (x * z - y * w),
+		2.0f * (x * y - z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + x * w),
+		2.0f * (x * z + y * w), 2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y)
+	};
+
+	for (int column = 0; column < 3; column++) {
+		for (int row = 0; row < 3; row++) {
+			matrix[column * 4 + row] = rotation[column * 3 + row] * s[column];
+		}
+		matrix[column * 4 + 3] = 0.0f;
+	}
+	matrix[12] = t[0];
+	matrix[13] = t[1];
+	matrix[14] = t[2];
+	matrix[15] = 1.0f;
+}
+
+// a glTF accessor's elements converted to floats, componentCount per element
+struct GltfAttribute {
+	std::vector<float> values;
+	uint32_t componentCount = 0;
+	size_t count = 0;
+};
+
+class GltfReader {
+	public:
+		GltfReader(const std::string& path) {
+			std::string data = readWholeFile(path);
+			std::string directory = path.substr(0, path.find_last_of('/') + 1);
+
+			std::string jsonText;
+			std::string binaryChunk;
+
+			// a .glb is a 12 byte header then chunks, the JSON first and optionally one binary buffer
+			const uint32_t GLB_MAGIC = 0x46546c67;
+			const uint32_t GLB_CHUNK_JSON = 0x4e4f534a;
+			const uint32_t GLB_CHUNK_BIN = 0x004e4942;
+
+			uint32_t magic = 0;
+			if (data.size() >= 12) {
+				std::memcpy(&magic, data.data(), sizeof(magic));
+			}
+
+			if (magic == GLB_MAGIC) {
+				for (size_t offset = 12; offset + 8 <= data.size();) {
+					uint32_t chunkLength;
+					uint32_t chunkType;
+					std::memcpy(&chunkLength, data.data() + offset, sizeof(chunkLength));
+					std::memcpy(&chunkType, data.data() + offset + 4, sizeof(chunkType));
+					if (offset + 8 + chunkLength > data.size()) {
+						throw std::runtime_error("ERROR: " + path + " is truncated");
+					}
+
+					if (chunkType == GLB_CHUNK_JSON) {
+						jsonText = data.substr(offset + 8, chunkLength);
+					}
+					else if (chunkType == GLB_CHUNK_BIN && binaryChunk.empty()) {
+						binaryChunk = data.substr(offset + 8, chunkLength);
+					}
+					offset += 8 + chunkLength;
+				}
+			}
+			else {
+				jsonText = std::move(data);
+			}
+
+			json = JsonValue::parse(jsonText);
+
+			if (const JsonValue* bufferList = json.find("buffers")) {
+				for (size_t i = 0; i < bufferList->size(); i++) {
+					const JsonValue* uri = (*bufferList)[i].find("uri");
+					if (uri == nullptr) {
+						buffers.push_back(binaryChunk);
+					}
+					else if (uri->asString().compare(0, 5, "data:") == 0) {
+						size_t dataStart = uri->asString().find("base64,");
+						if (dataStart == std::string::npos) {
+							throw std::runtime_error("ERROR: " + path + " has a data URI which is not base64");
+						}
+						buffers.push_back(decodeBase64(uri->asString(), dataStart + 7));
+					}
+					else {
+						buffers.push_back(readWholeFile(directory + uri->asString()));
+					}
+				}
+			}
+		}
+
+		const JsonValue& getJson() const {
+			return json;
+		}
+
+		GltfAttribute readAccessor(uint64_t index) const {
+			const JsonValue& accessor = json["accessors"][index];
+			if (accessor.find("sparse") != nullptr) {
+				throw std::runtime_error("ERROR: Sparse glTF accessors are not supported");
+			}
+
+			GltfAttribute attribute;
+			attribute.count = accessor["count"].asIndex();
+
+			const std::string& type = accessor["type"].asString();
+			if (type == "SCALAR") {
+				attribute.componentCount = 1;
+			}
+			else if (type == "VEC2") {
+				attribute.componentCount = 2;
+			}
+			else if (type == "VEC3") {
+				attribute.componentCount = 3;
+			}
+			else if (type == "VEC4") {
+				attribute.componentCount = 4;
+			}
+			else {
+				throw std::runtime_error("ERROR: glTF accessor type " + type + " is not supported");
+			}
+
+			attribute.values.assign(attribute.count * attribute.componentCount, 0.0f);
+
+			uint32_t componentType = static_cast<uint32_t>(accessor["componentType"].asIndex());
+			size_t componentSize = getComponentSize(componentType);
+			bool normalized = accessor.find("normalized") != nullptr && accessor["normalized"].asBool();
+
+			size_t stride;
+			const char* data = locate(accessor, componentSize * attribute.componentCount, attribute.count, stride);
+			if (data == nullptr) {
+				return attribute;
+			}
+
+			for (size_t element = 0; element < attribute.count; element++) {
+				const char* source = data + element * stride;
+				for (uint32_t component = 0; component < attribute.componentCount; component++) {
+					attribute.values[element * attribute.componentCount + component] = readComponent(source + component * componentSize, componentType, normalized);
+				}
+			}
+
+			return attribute;
+		}
+
+		// indices are read as integers, as floats would lose precision past 2^24 vertices
+		std::vector<uint32_t> readIndices(uint64_t index) const {
+			const JsonValue& accessor = json["accessors"][index];
+			uint32_t componentType = static_cast<uint32_t>(accessor["componentType"].asIndex());
+			if (accessor["type"].asString() != "SCALAR" || (componentType != 5121 && componentType != 5123 && componentType != 5125)) {
+				throw std::runtime_error("ERROR: glTF indices must be unsigned integer scalars");
+			}
+
+			size_t count = accessor["count"].asIndex();
+			std::vector<uint32_t> indices(count, 0);
+
+			size_t componentSize = getComponentSize(componentType);
+			size_t stride;
+			const char* data = locate(accessor, componentSize, count, stride);
+			if (data == nullptr) {
+				return indices;
+			}
+
+			for (size_t i = 0; i < count; i++) {
+				const char* source = data + i * stride;
+				if (componentType == 5125) {
+					std::memcpy(&indices[i], source, sizeof(uint32_t));
+				}
+				else if (componentType == 5123) {
+					uint16_t value;
+					std::memcpy(&value, source, sizeof(value));
+					indices[i] = value;
+				}
+				else {
+					indices[i] = static_cast<uint8_t>(*source);
+				}
+			}
+
+			return indices;
+		}
+
+	private:
+		JsonValue json;
+		std::vector<std::string> buffers;
+
+		static size_t getComponentSize(uint32_t componentType) {
+			return componentType == 5126 || componentType == 5125 ? 4 : componentType == 5123 || componentType == 5122 ? 2 : 1;
+		}
+
+		// start of the accessor's first element, or nullptr for accessors without a buffer view, which are all zeros
+		const char* locate(const JsonValue& accessor, size_t elementSize, size_t count, size_t& stride) const {
+			const JsonValue* viewIndex = accessor.find("bufferView");
+			if (viewIndex == nullptr) {
+				return nullptr;
+			}
+
+			const JsonValue& view = json["bufferViews"][viewIndex->asIndex()];
+			const std::string& buffer = buffers.at(view["buffer"].asIndex());
+			stride = static_cast<size_t>(view.numberOr("byteStride", static_cast<double>(elementSize)));
+			size_t offset = static_cast<size_t>(view.numberOr("byteOffset", 0.0) + accessor.numberOr("byteOffset", 0.0));
+
+			if (count > 0 && offset + stride * (count - 1) + elementSize > buffer.size()) {
+				throw std::runtime_error("ERROR: glTF accessor reads past the end of its buffer");
+			}
+
+			return buffer.data() + offset;
+		}
+
+		static float readComponent(const char* source, uint32_t componentType, bool normalized) {
+			if (componentType == 5126) {
+				float value;
+				std::memcpy(&value, source, sizeof(value));
+				return value;
+			}
+			else if (componentType == 5125) {
+				uint32_t value;
+				std::memcpy(&value, source, sizeof(value));
+				return static_cast<float>(value);
+			}
+			else if (componentType == 5123) {
+				uint16_t value;
+				std::memcpy(&value, source, sizeof(value));
+				return normalized ? value / 65535.0f : value;
+			}
+			else if (componentType == 5122) {
+				int16_t value;
+				std::memcpy(&value, source, sizeof(value));
+				return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+			}
+			else if (componentType == 5121) {
+				uint8_t value = static_cast<uint8_t>(*source);
+				return normalized ? value / 255.0f : value;
+			}
+			else if (componentType == 5120) {
+				int8_t value = static_cast<int8_t>(*source);
+				return normalized ? std::max(value / 127.0f, -1.0f) : value;
+			}
+
+			throw std::runtime_error("ERROR: Unknown glTF component type");
+		}
+};
+
+// reads every triangle primitive of the default scene in world space, primitives are converted on every thread of the pool
+inline Mesh importGltf(const std::string& path, WorkerPool& pool, MeshImportStats& stats) {
+	auto parseStart = std::chrono::steady_clock::now();
+
+	GltfReader reader(path);
+	const JsonValue& json = reader.getJson();
+
+	struct PrimitiveTask {
+		const JsonValue* primitive;
+		float matrix[16];
+		std::vector<Vertex> vertices;
+		std::vector<uint32_t> indices;
+	};
+	std::vector<PrimitiveTask> tasks;
+
+	auto addMesh = [&](uint64_t meshIndex, const float* matrix) {
+		const JsonValue& primitives = json["meshes"][meshIndex]["primitives"];
+		for (size_t i = 0; i < primitives.size(); i++) {
+			// points and lines have nothing to draw as triangles
+			if (primitives[i].numberOr("mode", 4.0) != 4.0) {
+				continue;
+			}
+
+			tasks.emplace_back();
+			tasks.back().primitive = &primitives[i];
+			std::memcpy(tasks.back().matrix, matrix, sizeof(tasks.back().matrix));
+		}
+	};
+
+	const float IDENTITY[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+	const JsonValue* scenes = json.find("scenes");
+	const JsonValue* nodes = json.find("nodes");
+
+	if (scenes != nullptr && nodes != nullptr && scenes->size() > 0) {
+		// walk the node hierarchy of the default scene, accumulating transforms
+		const JsonValue& scene = (*scenes)[static_cast<size_t>(json.numberOr("scene", 0.0))];
+		std::vector<std::pair<uint64_t, std::vector<float>>> stack;
+		if (const JsonValue* roots = scene.find("nodes")) {
+			for (size_t i = 0; i < roots->size(); i++) {
+				stack.emplace_back((*roots)[i].asIndex(), std::vector<float>(IDENTITY, IDENTITY + 16));
+			}
+		}
+
+		// every node has at most one parent, so visiting more nodes than there are means the hierarchy has a cycle
+		size_t visited = 0;
+		while (!stack.empty()) {
+			auto entry = std::move(stack.back());
+			stack.pop_back();
+			if (++visited > nodes->size()) {
+				throw std::runtime_error("ERROR: " + path + " has a cycle in its node hierarchy");
+			}
+
+			const JsonValue& node = (*nodes)[entry.first];
+			float local[16];
+			float world[16];
+			nodeMatrix(node, local);
+			multiplyMatrices(entry.second.data(), local, world);
+
+			if (const JsonValue* meshIndex = node.find("mesh")) {
+				addMesh(meshIndex->asIndex(), world);
+			}
+			if (const JsonValue* children = node.find("children")) {
+				for (size_t i = 0; i < children->size(); i++) {
+					stack.emplace_back((*children)[i].asIndex(), std::vector<float>(world, world + 16));
+				}
+			}
+		}
+	}
+	else if (const JsonValue* meshes = json.find("meshes")) {
+		// no scene, so every mesh as it is
+		for (size_t i = 0; i < meshes->size(); i++) {
+			addMesh(i, IDENTITY);
+		}
+	}
+
+	pool.run([&](uint32_t thread) {
+		for (size_t t = thread; t < tasks.size(); t += pool.getThreadCount()) {
+			PrimitiveTask& task = tasks[t];
+			const JsonValue& attributes = (*task.primitive)["attributes"];
+
+			GltfAttribute positions = reader.readAccessor(attributes["POSITION"].asIndex());
+			if (positions.componentCount != 3) {
+				throw std::runtime_error("ERROR: " + path + " has positions which are not 3D");
+			}
+			GltfAttribute normals;
+			GltfAttribute colours;
+			if (const JsonValue* index = attributes.find("NORMAL")) {
+				normals = reader.readAccessor(index->asIndex());
+				if (normals.componentCount != 3) {
+					throw std::runtime_error("ERROR: " + path + " has normals which are not 3D");
+				}
+			}
+			if (const JsonValue* index = attributes.find("COLOR_0")) {
+				colours = reader.readAccessor(index->asIndex());
+				if (colours.componentCount != 3 && colours.componentCount != 4) {
+					throw std::runtime_error("ERROR: " + path + " has colours which are neither RGB nor RGBA");
+				}
+			}
+
+			const float* m = task.matrix;
+			task.vertices.resize(positions.count);
+			for (size_t v = 0; v < positions.count; v++) {
+				const float* p = &positions.values[v * 3];
+				Vertex& vertex = task.vertices[v];
+				for (int row = 0; row < 3; row++) {
+					vertex.position[row] = m[row] * p[0] + m[4 + row] * p[1] + m[8 + row] * p[2] + m[12 + row];
+				}
+
+				if (colours.count == positions.count) {
+					std::memcpy(vertex.colour, &colours.values[v * colours.componentCount], sizeof(vertex.colour));
+				}
+				else if (normals.count == positions.count) {
+					// rotated with the upper 3x3, which is exact unless the node is scaled unevenly
+					const float* n = &normals.values[v * 3];
+					float normal[3];
+					for (int row = 0; row < 3; row++) {
+						normal[row] = m[row] * n[0] + m[4 + row] * n[1] + m[8 + row] * n[2];
+					}
+					colourFromNormal(normal, vertex.colour);
+				}
+				else {
+					vertex.colour[0] = vertex.colour[1] = vertex.colour[2] = 1.0f;
+				}
+			}
+
+			if (const JsonValue* index = task.primitive->find("indices")) {
+				task.indices = reader.readIndices(index->asIndex());
+				for (uint32_t i : task.indices) {
+					if (i >= positions.count) {
+						throw std::runtime_error("ERROR: " + path + " has an index past the end of its primitive");
+					}
+				}
+			}
+			else {
+				task.indices.resize(positions.count);
+				for (size_t i = 0; i < positions.count; i++) {
+					task.indices[i] = static_cast<uint32_t>(i);
+				}
+			}
+			task.indices.resize(task.indices.size() / 3 * 3);
+		}
+	});
+
+	auto deduplicateStart = std::chrono::steady_clock::now();
+
+	Mesh mesh;
+	size_t vertexCount = 0;
+	size_t indexCount = 0;
+	for (const auto& task : tasks) {
+		vertexCount += task.vertices.size();
+		indexCount += task.indices.size();
+	}
+	mesh.indices.reserve(indexCount);
+
+	// vertices are merged across primitives too, as meshes are often split along material boundaries
+	VertexDeduplicator deduplicator(mesh.vertices, vertexCount);
+	std::vector<uint32_t> remap;
+	for (auto& task : tasks) {
+		remap.resize(task.vertices.size());
+		for (size_t v = 0; v < task.vertices.size(); v++) {
+			remap[v] = deduplicator.add(task.vertices[v]);
+		}
+		for (uint32_t index : task.indices) {
+			mesh.indices.push_back(remap[index]);
+		}
+		task.vertices = std::vector<Vertex>();
+		task.indices = std::vector<uint32_t>();
+	}
+
+	if (mesh.indices.empty()) {
+		throw std::runtime_error("ERROR: " + path + " has no triangles");
+	}
+
+	stats.sourceVertices = vertexCount;
+	stats.parseMs = std::chrono::duration<double, std::milli>(deduplicateStart - parseStart).count();
+	stats.deduplicateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - deduplicateStart).count();
+
+	return mesh;
+}
+
+// picks the importer by file extension
+inline Mesh importMesh(const std::string& path, WorkerPool& pool, MeshImportStats& stats) {
+	std::string extension = path.substr(path.find_last_of('.') + 1);
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) {
+		return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+	});
+
+	Mesh mesh;
+	if (extension == "obj") {
+		mesh = importObj(path, pool, stats);
+	}
+	else if (extension == "gltf" || extension == "glb") {
+		mesh = importGltf(path, pool, stats);
+	}
+	else {
+		throw std::runtime_error("ERROR: Unsupported mesh format " + path + ", expected .obj, .gltf or .glb");
+	}
+
+	if (mesh.vertices.size() > UINT32_MAX) {
+		throw std::runtime_error("ERROR: " + path + " has more vertices than 32 bit indices can address");
+	}
+
+	stats.threads = pool.getThreadCount();
+	stats.peakMemoryBytes = peakResidentBytes();
+
+	return mesh;
+}
@@ -0,0 +1,301 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+
+#include "geometry.hpp"
+
+// FIFO post-transform cache the statistics are measured against, about the size of the caches of current GPUs
+const uint32_t VERTEX_CACHE_SIZE = 16;
+// LRU cache modelled while reordering, larger than the measured one so the order degrades gracefully on smaller caches
+const uint32_t VERTEX_CACHE_MODEL_SIZE = 32;
+
+struct VertexCacheStats {
+	// average cache miss ratio, vertices transformed per triangle: 3 is the worst, 0.5 the best for regular meshes
+	double acmr = 0.0;
+	// average transform to vertex ratio, vertices transformed per vertex: 1 is ideal
+	double atvr = 0.0;
+};
+
+inline VertexCacheStats analyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = VERTEX_CACHE_SIZE) {
+	VertexCacheStats stats;
+	if (indices.empty() || vertexCount == 0) {
+		return stats;
+	}
+
+	// each vertex remembers the miss which brought it into the cache, it is evicted by the cacheSize'th miss after that
+	std::vector<uint64_t> entered(vertexCount, 0);
+	uint64_t misses = 0;
+
+	for (uint32_t index : indices) {
+		if (entered[index] == 0 || misses - entered[index] >= cacheSize) {
+			misses++;
+			entered[index] = misses;
+		}
+	}
+
+	stats.acmr = static_cast<double>(misses) / (indices.size() / 3);
+	stats.atvr = static_cast<double>(misses) / vertexCount;
+
+	return stats;
+}
+
+// vertex score from Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+inline float vertexCacheScore(int32_t cachePosition, uint32_t liveTriangles) {
+	if (liveTriangles == 0) {
+		return -1.0f;
+	}
+
+	float score = 0.0f;
+	if (cachePosition >= 0) {
+		// the most recent triangle's vertices are scored equally, so the order within it does not matter
+		score = cachePosition < 3 ? 0.75f : std::pow(1.0f - static_cast<float>(cachePosition - 3) / (VERTEX_CACHE_MODEL_SIZE - 3), 1.5f);
+	}
+
+	// vertices with few triangles left are finished off first, so they do not have to be transformed again later
+	return score + 2.0f / std::sqrt(static_cast<float>(liveTriangles));
+}
+
+// reorders triangles so consecutive ones share vertices still in the post-transform cache
+inline std::vector<uint32_t> optimizeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount) {
+	size_t triangleCount = indices.size() / 3;
+
+	// triangles using each vertex, as ranges of one array, live ones are kept at the front of each range
+	std::vector<uint32_t> liveTriangles(vertexCount, 0);
+	for (uint32_t index : indices) {
+		liveTriangles[index]++;
+	}
+
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (size_t i = 0; i < vertexCount; i++) {
+		adjacencyOffsets[i + 1] = adjacencyOffsets[i] + liveTriangles[i];
+	}
+
+	std::vector<uint32_t> adjacency(indices.size());
+	std::vector<uint32_t> fillOffsets(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+	for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+		for (size_t corner = 0; corner < 3; corner++) {
+			adjacency[fillOffsets[indices[triangle * 3 + corner]]++] = static_cast<uint32_t>(triangle);
+		}
+	}
+
+	std::vector<int32_t> cachePositions(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	for (size_t i = 0; i < vertexCount; i++) {
+		vertexScores[i] = vertexCacheScore(-1, liveTriangles[i]);
+	}
+
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<uint32_t> cache;
+	std::vector<uint32_t> nextCache;
+	cache.reserve(VERTEX_CACHE_MODEL_SIZE + 3);
+	nextCache.reserve(VERTEX_CACHE_MODEL_SIZE + 3);
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+
+	size_t restartCursor = 0;
+	int64_t bestTriangle = -1;
+
+	while (result.size() < triangleCount * 3) {
+		if (bestTriangle < 0) {
+			// nothing touching the cache is left, so carry on from the next triangle not yet emitted
+			while (emitted[restartCursor]) {
+				restartCursor++;
+			}
+			bestTriangle = static_cast<int64_t>(restartCursor);
+		}
+
+		uint32_t triangle = static_cast<uint32_t>(bestTriangle);
+		emitted[triangle] = true;
+
+		nextCache.clear();
+		for (size_t corner = 0; corner < 3; corner++) {
+			uint32_t vertex = indices[triangle * 3 + corner];
+			result.push_back(vertex);
+
+			uint32_t* live = adjacency.data() + adjacencyOffsets[vertex];
+			uint32_t* liveEnd = live + liveTriangles[vertex];
+			uint32_t* found = std::find(live, liveEnd, triangle);
+			if (found != liveEnd) {
+				std::swap(*found, *(liveEnd - 1));
+				liveTriangles[vertex]--;
+			}
+
+			if (std::find(nextCache.begin(), nextCache.end(), vertex) == nextCache.end()) {
+				nextCache.push_back(vertex);
+			}
+		}
+
+		// the emitted triangle's vertices move to the front of the cache, pushing the rest back
+		size_t triangleVertexCount = nextCache.size();
+		for (uint32_t vertex : cache) {
+			if (std::find(nextCache.begin(), nextCache.begin() + triangleVertexCount, vertex) == nextCache.begin() + triangleVertexCount) {
+				nextCache.push_back(vertex);
+			}
+		}
+
+		for (size_t i = 0; i < nextCache.size(); i++) {
+			uint32_t vertex = nextCache[i];
+			cachePositions[vertex] = i < VERTEX_CACHE_MODEL_SIZE ? static_cast<int32_t>(i) : -1;
+			vertexScores[vertex] = vertexCacheScore(cachePositions[vertex], liveTriangles[vertex]);
+		}
+
+		// only triangles touching the cache changed score, and the best of them is emitted next
+		bestTriangle = -1;
+		float bestScore = -1.0f;
+		for (uint32_t vertex : nextCache) {
+			const uint32_t* live = adjacency.data() + adjacencyOffsets[vertex];
+			for (uint32_t i = 0; i < liveTriangles[vertex]; i++) {
+				uint32_t candidate = live[i];
+				float score = vertexScores[indices[candidate * 3]] + vertexScores[indices[candidate * 3 + 1]] + vertexScores[indices[candidate * 3 + 2]];
+				if (score > bestScore) {
+					bestScore = score;
+					bestTriangle = candidate;
+				}
+			}
+		}
+
+		if (nextCache.size() > VERTEX_CACHE_MODEL_SIZE) {
+			nextCache.resize(VERTEX_CACHE_MODEL_SIZE);
+		}
+		std::swap(cache, nextCache);
+	}
+
+	return result;
+}
+
+// keeps the cache friendly order within clusters of triangles, but draws clusters facing outwards from the mesh centre first
+// those tend to be in front of the rest, so fewer fragments are shaded only to be overwritten, after Sander et al. "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"
+inline std::vector<uint32_t> optimizeOverdraw(const std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices) {
+	size_t triangleCount = indices.size() / 3;
+
+	// clusters start wherever the cache order starts afresh, i.e. at triangles whose vertices all miss the cache
+	std::vector<size_t> clusterStarts;
+	std::vector<uint64_t> entered(vertices.size(), 0);
+	uint64_t misses = 0;
+	for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+		uint32_t triangleMisses = 0;
+		for (size_t corner = 0; corner < 3; corner++) {
+			uint32_t index = indices[triangle * 3 + corner];
+			if (entered[index] == 0 || misses - entered[index] >= VERTEX_CACHE_SIZE) {
+				misses++;
+				entered[index] = misses;
+				triangleMisses++;
+			}
+		}
+		if (triangle == 0 || triangleMisses == 3) {
+			clusterStarts.push_back(triangle);
+		}
+	}
+	clusterStarts.push_back(triangleCount);
+
+	struct Cluster {
+		size_t start;
+		size_t end;
+		float centroid[3];
+		float normal[3];
+		float sortKey;
+	};
+
+	std::vector<Cluster> clusters(clusterStarts.size() - 1);
+	float meshCentroid[3] = {0.0f, 0.0f, 0.0f};
+	float meshArea = 0.0f;
+
+	for (size_t i = 0; i < clusters.size(); i++) {
+		Cluster& cluster = clusters[i];
+		cluster = {clusterStarts[i], clusterStarts[i + 1], {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, 0.0f};
+
+		// area weighted, the cross product's length being twice the triangle's area
+		float clusterArea = 0.0f;
+		for (size_t triangle = cluster.start; triangle < cluster.end; triangle++) {
+			const float* a = vertices[indices[triangle * 3]].position;
+			const float* b = vertices[indices[triangle * 3 + 1]].position;
+			const float* c = vertices[indices[triangle * 3 + 2]].position;
+
+			float ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+			float ac[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+			float cross[3] = {ab[1] * ac[2] - ab[2] * ac[1], ab[2] * ac[0] - ab[0] * ac[2], ab[0] * ac[1] - ab[1] * ac[0]};
+			float area = std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+
+			for (int axis = 0; axis < 3; axis++) {
+				cluster.centroid[axis] += (a[axis] + b[axis] + c[axis]) / 3.0f * area;
+				cluster.normal[axis] += cross[axis];
+			}
+			clusterArea += area;
+		}
+
+		for (int axis = 0; axis < 3; axis++) {
+			meshCentroid[axis] += cluster.centroid[axis];
+			cluster.centroid[axis] = clusterArea > 0.0f ? cluster.centroid[axis] / clusterArea : 0.0f;
+		}
+		meshArea += clusterArea;
+	}
+
+	for (int axis = 0; axis < 3; axis++) {
+		meshCentroid[axis] = meshArea > 0.0f ? meshCentroid[axis] / meshArea : 0.0f;
+	}
+
+	for (auto& cluster : clusters) {
+		float length = std::sqrt(cluster.normal[0] * cluster.normal[0] + cluster.normal[1] * cluster.normal[1] + cluster.normal[2] * cluster.normal[2]);
+		if (length > 0.0f) {
+			cluster.sortKey = ((cluster.centroid[0] - meshCentroid[0]) * cluster.normal[0] + (cluster.centroid[1] - meshCentroid[1]) * cluster.normal[1] + (cluster.centroid[2] - meshCentroid[2]) * cluster.normal[2]) / length;
+		}
+	}
+
+	std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) {
+		return a.sortKey > b.sortKey;
+	});
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+	for (const auto& cluster : clusters) {
+		result.insert(result.end(), indices.begin() + cluster.start * 3, indices.begin() + cluster.end * 3);
+	}
+
+	return result;
+}
+
+// renumbers vertices in the order the triangles first use them, so vertex fetches walk through memory, and drops unused ones
+inline void optimizeVertexFetch(Mesh& mesh) {
+	std::vector<uint32_t> remap(mesh.vertices.size(), UINT32_MAX);
+	std::vector<Vertex> vertices;
+	vertices.reserve(mesh.vertices.size());
+
+	for (uint32_t& index : mesh.indices) {
+		if (remap[index] == UINT32_MAX) {
+			remap[index] = static_cast<uint32_t>(vertices.size());
+			vertices.push_back(mesh.vertices[index]);
+		}
+		index = remap[index];
+	}
+
+	mesh.vertices = std::move(vertices);
+}
+
+struct MeshOptimizationStats {
+	VertexCacheStats before;
+	VertexCacheStats after;
+	double optimizeMs = 0.0;
+};
+
+// triangle order for the vertex cache and overdraw, then vertex order for fetching
+inline MeshOptimizationStats optimizeMesh(Mesh& mesh) {
+	MeshOptimizationStats stats;
+	auto start = std::chrono::steady_clock::now();
+
+	stats.before = analyzeVertexCache(mesh.indices, mesh.vertices.size());
+
+	mesh.indices = optimizeVertexCache(mesh.indices, mesh.vertices.size());
+	mesh.indices = optimizeOverdraw(mesh.indices, mesh.vertices);
+	optimizeVertexFetch(mesh);
+
+	stats.after = analyzeVertexCache(mesh.indices, mesh.vertices.size());
+	stats.optimizeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	return stats;
+}
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "geometry.hpp"
+#include "gpu_buffer.hpp"
+
+// simulated time per frame, fixed so results and throughput do not depend on the frame rate
+const float PARTICLE_TIME_STEP = 1.0f / 60.0f;
+
+// matches the push constant block in particles.comp
+struct ParticlePushConstants {
+	float deltaTime;
+	uint32_t particleCount;
+};
+
+// integrates particle positions and velocities in a compute shader, ping-ponging between two copies of the state each frame
+// positions are stored as InstanceData, so the output is drawn directly by the instanced triangle pipeline without a CPU round trip
+class ParticleSystem {
+	public:
+		static VkDescriptorSetLayout createDescriptorSetLayout(VkDevice logicalDevice) {
+			// instances and velocities in, instances and velocities out
+			VkDescriptorSetLayoutBinding bindings[4]{};
+			for (uint32_t i = 0; i < 4; i++) {
+				bindings[i].binding = i;
+				bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				bindings[i].descriptorCount = 1;
+				bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+			}
+
+			VkDescriptorSetLayoutCreateInfo layoutCreateInfo{};
+			layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+			layoutCreateInfo.bindingCount = 4;
+			layoutCreateInfo.pBindings = bindings;
+
+			VkDescriptorSetLayout layout;
+			if (vkCreateDescriptorSetLayout(logicalDevice, &layoutCreateInfo, nullptr, &layout) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to create particle descriptor set layout");
+			}
+
+			return layout;
+		}
+
+		void create(GpuAllocator& gpuAllocator, VkDevice logicalDevice, StagingUploader& uploader, VkDescriptorSetLayout descriptorSetLayout, uint32_t count) {
+			allocator = &gpuAllocator;
+			device = logicalDevice;
+			particleCount = count;
+
+			std::vector<InstanceData> instances(count);
+			std::vector<float> velocities(count * 2);
+			initialiseParticles(instances, velocities);
+
+			// both copies start from the same state, whichever is read first
+			for (uint32_t i = 0; i < 2; i++) {
+				instanceBuffers[i] = uploader.createDeviceLocalBuffer(instances.data(), sizeof(InstanceData) * instances.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+				velocityBuffers[i] = uploader.createDeviceLocalBuffer(velocities.data(), sizeof(float) * velocities.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+			}
+
+			VkDescriptorPoolSize poolSize{};
+			poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			poolSize.descriptorCount = 8;
+
+			VkDescriptorPoolCreateInfo poolCreateInfo{};
+			poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+			poolCreateInfo.maxSets = 2;
+			poolCreateInfo.poolSizeCount = 1;
+			poolCreateInfo.pPoolSizes = &poolSize;
+
+			if (vkCreateDescriptorPool(device, &poolCreateInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to create particle descriptor pool");
+			}
+
+			VkDescriptorSetLayout layouts[2] = {descriptorSetLayout, descriptorSetLayout};
+
+			VkDescriptorSetAllocateInfo setAllocateInfo{};
+			setAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			setAllocateInfo.descriptorPool = descriptorPool;
+			setAllocateInfo.descriptorSetCount = 2;
+			setAllocateInfo.pSetLayouts = layouts;
+
+			if (vkAllocateDescriptorSets(device, &setAllocateInfo, descriptorSets) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to allocate particle descriptor sets");
+			}
+
+			// set i reads copy i and writes the other one
+			for (uint32_t i = 0; i < 2; i++) {
+				VkDescriptorBufferInfo bufferInfos[4]{};
+				bufferInfos[0] = {instanceBuffers[i].buffer, 0, VK_WHOLE_SIZE};
+				bufferInfos[1] = {velocityBuffers[i].buffer, 0, VK_WHOLE_SIZE};
+				bufferInfos[2] = {instanceBuffers[1 - i].buffer, 0, VK_WHOLE_SIZE};
+				bufferInfos[3] = {velocityBuffers[1 - i].buffer, 0, VK_WHOLE_SIZE};
+
+				VkWriteDescriptorSet descriptorWrite{};
+				descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				descriptorWrite.dstSet = descriptorSets[i];
+				descriptorWrite.dstBinding = 0;
+				descriptorWrite.dstArrayElement = 0;
+				descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				descriptorWrite.descriptorCount = 4;
+				descriptorWrite.pBufferInfo = bufferInfos;
+
+				vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+			}
+		}
+
+		void destroy() {
+			if (device == VK_NULL_HANDLE) {
+				return;
+			}
+
+			for (uint32_t i = 0; i < 2; i++) {
+				destroyBuffer(*allocator, device, instanceBuffers[i]);
+				destroyBuffer(*allocator, device, velocityBuffers[i]);
+			}
+
+			vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+		}
+
+		// must be recorded outside of a render pass, commands are recorded in submission order so the copies alternate every frame
+		void cmdSimulate(VkCommandBuffer commandBuffer, VkPipeline pipeline, VkPipelineLayout pipelineLayout) {
+			// the previous frame's simulation wrote the state read here, and the copy written here may still be read by an earlier frame's draws
+			VkMemoryBarrier previousFrameBarrier{};
+			previousFrameBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			previousFrameBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			previousFrameBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &previousFrameBarrier, 0, nullptr, 0, nullptr);
+
+			ParticlePushConstants pushConstants{};
+			pushConstants.deltaTime = PARTICLE_TIME_STEP;
+			pushConstants.particleCount = particleCount;
+
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSets[current], 0, nullptr);
+			vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ParticlePushConstants), &pushConstants);
+			vkCmdDispatch(commandBuffer, (particleCount + PARTICLE_WORKGROUP_SIZE - 1) / PARTICLE_WORKGROUP_SIZE, 1, 1);
+
+			// the new positions are read as instance attributes by this frame's draws
+			VkMemoryBarrier simulationBarrier{};
+			simulationBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			simulationBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			simulationBarrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 1, &simulationBarrier, 0, nullptr, 0, nullptr);
+
+			current = 1 - current;
+		}
+
+		// the copy written by the most recently recorded simulation step
+		VkBuffer getInstanceBuffer() const {
+			return instanceBuffers[current].buffer;
+		}
+
+		uint32_t getParticleCount() const {
+			return particleCount;
+		}
+
+	private:
+		// must match local_size_x in particles.comp
+		static const uint32_t PARTICLE_WORKGROUP_SIZE = 256;
+
+		GpuAllocator* allocator = nullptr;
+		VkDevice device = VK_NULL_HANDLE;
+		uint32_t particleCount = 0;
+
+		GpuBuffer instanceBuffers[2];
+		GpuBuffer velocityBuffers[2];
+		VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+		VkDescriptorSet descriptorSets[2];
+		// copy read by the next simulation step
+		uint32_t current = 0;
+
+		void initialiseParticles(std::vector<InstanceData>& instances, std::vector<float>& velocities) {
+			// fixed seed so every run simulates the same scene
+			std::mt19937 generator(12345);
+			std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+			std::uniform_real_distribution<float> speed(-0.1f, 0.1f);
+
+			// shrink the particles as their number grows, so the scene's fill rate stays roughly constant
+			float scale = std::clamp(2.0f / std::sqrt(static_cast<float>(instances.size())), 0.002f, 0.05f);
+
+			for (size_t i = 0; i < instances.size(); i++) {
+				instances[i].offset[0] = position(generator);
+				instances[i].offset[1] = position(generator);
+				instances[i].scale = scale;
+				instances[i].colour = 0xffffffff;
+
+				velocities[i * 2] = speed(generator);
+				velocities[i * 2 + 1] = speed(generator);
+			}
+		}
+};
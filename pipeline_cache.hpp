@@ -0,0 +1,247 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <mutex>
+
+#include <unistd.h>
+
+// 'VTPC' in little endian
+const uint32_t PIPELINE_CACHE_FILE_MAGIC = 0x43505456;
+const uint32_t PIPELINE_CACHE_FILE_VERSION = 1;
+
+// written in front of the driver's cache data, as the driver's own header does not include the driver version and a
+// mismatched blob must be rejected before it reaches the driver
+struct PipelineCacheFileHeader {
+	uint32_t magic;
+	uint32_t fileVersion;
+	uint32_t vendorID;
+	uint32_t deviceID;
+	uint32_t driverVersion;
+	uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+	uint64_t dataSize;
+	uint64_t dataChecksum;
+	// pipeline compile time measured on the run which created the cache, used to estimate the time saved by later runs
+	double coldCompileMs;
+};
+
+struct PipelineCacheStats {
+	bool enabled = false;
+	bool hit = false;
+	std::string missReason;
+	size_t loadedBytes = 0;
+	double compileMs = 0.0;
+	double coldCompileMs = 0.0;
+
+	double savedMs() const {
+		return hit ? coldCompileMs - compileMs : 0.0;
+	}
+};
+
+// VkPipelineCache persisted between runs, keyed by device and driver so a driver update or different GPU starts from an empty cache
+class PipelineCache {
+	public:
+		// reads the cache file into memory without validating it, needs no Vulkan objects so it can run before the device exists
+		// an empty path disables persistence, pipelines are then compiled without a cache
+		void readCacheFile(const std::string& cachePath) {
+			path = cachePath;
+			stats.enabled = !path.empty();
+
+			if (!stats.enabled) {
+				return;
+			}
+
+			std::ifstream file(path, std::ios::ate | std::ios::binary);
+
+			if (!file.is_open()) {
+				return;
+			}
+
+			fileData.resize((size_t) file.tellg());
+			file.seekg(0);
+			file.read(fileData.data(), fileData.size());
+			fileExists = true;
+		}
+
+		// validates the data read by readCacheFile() against the device and creates the cache from it
+		void create(VkPhysicalDevice physicalDevice, VkDevice logicalDevice) {
+			device = logicalDevice;
+
+			vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+
+			if (!stats.enabled) {
+				return;
+			}
+
+			std::vector<char> initialData = validateFileData();
+			// the raw file is no longer needed once validated
+			fileData = std::vector<char>();
+
+			VkPipelineCacheCreateInfo createInfo{};
+			createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+			createInfo.initialDataSize = initialData.size();
+			createInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+			if (vkCreatePipelineCache(device, &createInfo, nullptr, &cache) != VK_SUCCESS) {
+				// the driver may still reject data which passed our checks, fall back to an empty cache
+				stats.hit = false;
+				stats.missReason = "rejected by driver";
+				createInfo.initialDataSize = 0;
+				createInfo.pInitialData = nullptr;
+
+				if (vkCreatePipelineCache(device, &createInfo, nullptr, &cache) != VK_SUCCESS) {
+					throw std::runtime_error("ERROR: Failed to create pipeline cache");
+				}
+			}
+		}
+
+		// writes to a temporary file which is renamed over the old cache, so a crash part way through never leaves a corrupt cache behind
+		void save() {
+			if (cache == VK_NULL_HANDLE) {
+				return;
+			}
+
+			size_t dataSize = 0;
+			vkGetPipelineCacheData(device, cache, &dataSize, nullptr);
+
+			std::vector<char> data(dataSize);
+			if (vkGetPipelineCacheData(device, cache, &dataSize, data.data()) != VK_SUCCESS) {
+				std::cerr << "WARNING: Failed to retrieve pipeline cache data" << std::endl;
+				return;
+			}
+			data.resize(dataSize);
+
+			PipelineCacheFileHeader header = makeHeader();
+			header.dataSize = data.size();
+			header.dataChecksum = checksum(data);
+			// keep the cold compile time from the run which populated the cache, otherwise this run was the cold one
+			header.coldCompileMs = stats.hit ? stats.coldCompileMs : stats.compileMs;
+
+			std::string temporaryPath = path + ".tmp";
+			FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+
+			if (file == nullptr) {
+				std::cerr << "WARNING: Failed to open " << temporaryPath << " for writing" << std::endl;
+				return;
+			}
+
+			bool written = std::fwrite(&header, sizeof(header), 1, file) == 1 && std::fwrite(data.data(), 1, data.size(), file) == data.size();
+			// make sure the data is on disk before the rename makes it visible
+			written = written && std::fflush(file) == 0 && fsync(fileno(file)) == 0;
+			written = std::fclose(file) == 0 && written;
+
+			if (!written || std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+				std::cerr << "WARNING: Failed to write pipeline cache " << path << std::endl;
+				std::remove(temporaryPath.c_str());
+			}
+		}
+
+		void destroy() {
+			if (cache != VK_NULL_HANDLE) {
+				vkDestroyPipelineCache(device, cache, nullptr);
+				cache = VK_NULL_HANDLE;
+			}
+		}
+
+		VkPipelineCache getHandle() const {
+			return cache;
+		}
+
+		// time spent in vkCreate*Pipelines this run, pipelines may be compiled on several initialisation threads at once
+		void recordCompileTime(double milliseconds) {
+			std::lock_guard<std::mutex> lock(statsMutex);
+			stats.compileMs += milliseconds;
+		}
+
+		const PipelineCacheStats& getStats() const {
+			return stats;
+		}
+
+	private:
+		VkDevice device = VK_NULL_HANDLE;
+		VkPipelineCache cache = VK_NULL_HANDLE;
+		VkPhysicalDeviceProperties deviceProperties;
+		std::string path;
+
+		bool fileExists = false;
+		std::vector<char> fileData;
+
+		PipelineCacheStats stats;
+		std::mutex statsMutex;
+
+		PipelineCacheFileHeader makeHeader() const {
+			PipelineCacheFileHeader header{};
+			header.magic = PIPELINE_CACHE_FILE_MAGIC;
+			header.fileVersion = PIPELINE_CACHE_FILE_VERSION;
+			header.vendorID = deviceProperties.vendorID;
+			header.deviceID = deviceProperties.deviceID;
+			header.driverVersion = deviceProperties.driverVersion;
+			std::memcpy(header.pipelineCacheUUID, deviceProperties.pipelineCacheUUID, VK_UUID_SIZE);
+			return header;
+		}
+
+		// returns the cached data if the file exists and was written for this device and driver, otherwise records why it missed and returns nothing
+		std::vector<char> validateFileData() {
+			if (!fileExists) {
+				stats.missReason = "no cache file";
+				return {};
+			}
+
+			size_t fileSize = fileData.size();
+			PipelineCacheFileHeader header;
+
+			if (fileSize < sizeof(header)) {
+				stats.missReason = "truncated header";
+				return {};
+			}
+
+			std::memcpy(&header, fileData.data(), sizeof(header));
+
+			PipelineCacheFileHeader expected = makeHeader();
+
+			if (header.magic != expected.magic || header.fileVersion != expected.fileVersion) {
+				stats.missReason = "unrecognised file format";
+				return {};
+			}
+
+			if (header.vendorID != expected.vendorID || header.deviceID != expected.deviceID || header.driverVersion != expected.driverVersion || std::memcmp(header.pipelineCacheUUID, expected.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+				stats.missReason = "device or driver changed";
+				return {};
+			}
+
+			if (fileSize - sizeof(header) != header.dataSize) {
+				stats.missReason = "truncated data";
+				return {};
+			}
+
+			std::vector<char> data(fileData.begin() + sizeof(header), fileData.end());
+
+			if (checksum(data) != header.dataChecksum) {
+				stats.missReason = "checksum mismatch";
+				return {};
+			}
+
+			stats.hit = true;
+			stats.loadedBytes = data.size();
+			stats.coldCompileMs = header.coldCompileMs;
+
+			return data;
+		}
+
+		// 64 bit FNV-1a, enough to catch truncation and bit rot
+		static uint64_t checksum(const std::vector<char>& data) {
+			uint64_t hash = 0xcbf29ce484222325;
+			for (char c : data) {
+				hash ^= static_cast<uint8_t>(c);
+				hash *= 0x100000001b3;
+			}
+			return hash;
+		}
+};
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+#include "frame_stats.hpp"
+
+// threads compiling missing variants, kept below the hardware thread count so compilation never competes with recording
+const uint32_t PIPELINE_VARIANT_THREADS = 2;
+
+// a 32 bit specialisation constant, floats are given by their bits
+struct SpecializationConstant {
+	VkShaderStageFlagBits stage;
+	uint32_t id;
+	uint32_t value;
+
+	bool operator==(const SpecializationConstant& other) const {
+		return stage == other.stage && id == other.id && value == other.value;
+	}
+};
+
+inline uint32_t specializationFloat(float value) {
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+// everything about a graphics pipeline that may vary between draws, the shaders, vertex input, layout and render pass are the same for every variant
+struct PipelineVariantDesc {
+	VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+	VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+	VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+	VkFrontFace frontFace = VK_FRONT_FACE_CLOCKWISE;
+	// source alpha blending, off writes the colour as it is
+	bool blendEnable = false;
+	VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+	std::vector<SpecializationConstant> constants;
+
+	bool operator==(const PipelineVariantDesc& other) const {
+		return topology == other.topology && polygonMode == other.polygonMode && cullMode == other.cullMode && frontFace == other.frontFace && blendEnable == other.blendEnable && samples == other.samples && constants == other.constants;
+	}
+
+	// the constants for one stage in the form pipeline creation takes them, data must outlive the returned info
+	VkSpecializationInfo getSpecializationInfo(VkShaderStageFlagBits stage, std::vector<VkSpecializationMapEntry>& entries, std::vector<uint32_t>& data) const {
+		for (const auto& constant : constants) {
+			if (constant.stage == stage) {
+				entries.push_back({constant.id, static_cast<uint32_t>(sizeof(uint32_t) * data.size()), sizeof(uint32_t)});
+				data.push_back(constant.value);
+			}
+		}
+
+		VkSpecializationInfo specializationInfo{};
+		specializationInfo.mapEntryCount = static_cast<uint32_t>(entries.size());
+		specializationInfo.pMapEntries = entries.data();
+		specializationInfo.dataSize = sizeof(uint32_t) * data.size();
+		specializationInfo.pData = data.data();
+
+		return specializationInfo;
+	}
+};
+
+// FNV-1a over every field, equal descriptions are still compared in full so a collision can never hand back the wrong pipeline
+struct PipelineVariantHash {
+	size_t operator()(const PipelineVariantDesc& desc) const {
+		uint64_t hash = 14695981039346656037ull;
+		auto mix = [&hash](uint32_t value) {
+			for (uint32_t byte = 0; byte < 4; byte++) {
+				hash ^= (value >> (8 * byte)) & 0xff;
+				hash *= 1099511628211ull;
+			}
+		};
+
+		mix(desc.topology);
+		mix(desc.polygonMode);
+		mix(desc.cullMode);
+		mix(desc.frontFace);
+		mix(desc.blendEnable ? 1 : 0);
+		mix(desc.samples);
+		for (const auto& constant : desc.constants) {
+			mix(constant.stage);
+			mix(constant.id);
+			mix(constant.value);
+		}
+
+		return static_cast<size_t>(hash);
+	}
+};
+
+struct PipelineVariantSummary {
+	uint64_t variants = 0;
+	uint64_t failures = 0;
+	// variants waiting for a compile thread now, and the most that ever were
+	uint64_t queueDepth = 0;
+	uint64_t maxQueueDepth = 0;
+	// requests answered with the variant itself rather than the fallback
+	uint64_t requests = 0;
+	uint64_t hits = 0;
+	// from a variant first being requested until it was ready, including time spent queued
+	PercentileSummary compileMs;
+
+	double hitRate() const {
+		return requests > 0 ? static_cast<double>(hits) / requests : 0.0;
+	}
+};
+
+// builds graphics pipeline variants on background threads the first time each is asked for
+// until a variant is ready the caller is handed its fallback, so drawing with a new variant never waits on the compiler
+class PipelineVariantManager {
+	public:
+		// creates the pipeline for one variant, called on the compile threads
+		using PipelineBuilder = std::function<VkPipeline(const PipelineVariantDesc&)>;
+
+		PipelineVariantManager() = default;
+		PipelineVariantManager(const PipelineVariantManager&) = delete;
+		PipelineVariantManager& operator=(const PipelineVariantManager&) = delete;
+
+		~PipelineVariantManager() {
+			stop();
+		}
+
+		void start(VkDevice logicalDevice, PipelineBuilder pipelineBuilder) {
+			device = logicalDevice;
+			builder = pipelineBuilder;
+
+			for (uint32_t i = 0; i < PIPELINE_VARIANT_THREADS; i++) {
+				threads.emplace_back([this] { compileLoop(); });
+			}
+		}
+
+		// call once the device is idle, abandons queued variants and destroys every one that was built
+		void stop() {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				stopping = true;
+				queue.clear();
+			}
+			queueCondition.notify_all();
+
+			for (auto& thread : threads) {
+				thread.join();
+			}
+			threads.clear();
+
+			for (auto& variant : variants) {
+				if (variant.second.pipeline != VK_NULL_HANDLE) {
+					vkDestroyPipeline(device, variant.second.pipeline, nullptr);
+				}
+			}
+			variants.clear();
+		}
+
+		// the variant's pipeline if it has been built, otherwise fallback, queueing the variant the first time it is asked for
+		VkPipeline get(const PipelineVariantDesc& desc, VkPipeline fallback) {
+			std::lock_guard<std::mutex> lock(mutex);
+			requests++;
+
+			auto found = variants.find(desc);
+			if (found == variants.end()) {
+				Variant& variant = variants[desc];
+				variant.requestTime = std::chrono::steady_clock::now();
+				queue.push_back(desc);
+				maxQueueDepth = std::max<uint64_t>(maxQueueDepth, queue.size());
+				queueCondition.notify_one();
+				return fallback;
+			}
+
+			if (found->second.pipeline == VK_NULL_HANDLE) {
+				return fallback;
+			}
+
+			hits++;
+			return found->second.pipeline;
+		}
+
+		PipelineVariantSummary summarise() {
+			std::lock_guard<std::mutex> lock(mutex);
+
+			PipelineVariantSummary summary;
+			summary.variants = built;
+			summary.failures = failures;
+			summary.queueDepth = queue.size();
+			summary.maxQueueDepth = maxQueueDepth;
+			summary.requests = requests;
+			summary.hits = hits;
+			summary.compileMs = compileMs.summarise();
+
+			return summary;
+		}
+
+	private:
+		struct Variant {
+			// VK_NULL_HANDLE while queued or compiling, and for good if the build failed
+			VkPipeline pipeline = VK_NULL_HANDLE;
+			std::chrono::steady_clock::time_point requestTime;
+		};
+
+		VkDevice device = VK_NULL_HANDLE;
+		PipelineBuilder builder;
+
+		std::vector<std::thread> threads;
+		std::mutex mutex;
+		std::condition_variable queueCondition;
+		bool stopping = false;
+
+		// entries are only erased by stop() once the compile threads have finished
+		std::unordered_map<PipelineVariantDesc, Variant, PipelineVariantHash> variants;
+		std::deque<PipelineVariantDesc> queue;
+
+		uint64_t built = 0;
+		uint64_t failures = 0;
+		uint64_t maxQueueDepth = 0;
+		uint64_t requests = 0;
+		uint64_t hits = 0;
+		SampleRing compileMs;
+
+		void compileLoop() {
+			while (true) {
+				PipelineVariantDesc desc;
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					queueCondition.wait(lock, [this] { return stopping || !queue.empty(); });
+					if (stopping) {
+						return;
+					}
+					desc = queue.front();
+					queue.pop_front();
+				}
+
+				// a failed variant is reported once and the fallback used from then on
+				VkPipeline pipeline = VK_NULL_HANDLE;
+				try {
+					pipeline = builder(desc);
+				}
+				catch (const std::exception& e) {
+					std::cerr << "Pipeline variant: " << e.what() << std::endl;
+				}
+
+				std::lock_guard<std::mutex> lock(mutex);
+				Variant& variant = variants[desc];
+				variant.pipeline = pipeline;
+				if (pipeline == VK_NULL_HANDLE) {
+					failures++;
+					continue;
+				}
+
+				built++;
+				compileMs.push(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - variant.requestTime).count());
+			}
+		}
+};
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <stdexcept>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+// widths of the sort key's fields, most significant first, so sorting groups draws by pass, pipeline, descriptor set and material and orders each group by depth
+const uint32_t SORT_KEY_PASS_BITS = 4;
+const uint32_t SORT_KEY_PIPELINE_BITS = 10;
+const uint32_t SORT_KEY_DESCRIPTOR_SET_BITS = 12;
+const uint32_t SORT_KEY_MATERIAL_BITS = 14;
+const uint32_t SORT_KEY_DEPTH_BITS = 24;
+
+static_assert(SORT_KEY_PASS_BITS + SORT_KEY_PIPELINE_BITS + SORT_KEY_DESCRIPTOR_SET_BITS + SORT_KEY_MATERIAL_BITS + SORT_KEY_DEPTH_BITS == 64, "The sort key fields must fill 64 bits");
+
+// depth is in [0, 1], nearer draws sort first
+inline uint64_t makeSortKey(uint32_t pass, uint32_t pipeline, uint32_t descriptorSet, uint32_t material, float depth) {
+	if (pass >> SORT_KEY_PASS_BITS != 0 || pipeline >> SORT_KEY_PIPELINE_BITS != 0 || descriptorSet >> SORT_KEY_DESCRIPTOR_SET_BITS != 0 || material >> SORT_KEY_MATERIAL_BITS != 0) {
+		throw std::runtime_error("ERROR: Sort key field out of range");
+	}
+
+	const uint32_t maxDepth = (1u << SORT_KEY_DEPTH_BITS) - 1;
+	uint32_t quantisedDepth = static_cast<uint32_t>(std::min(std::max(depth, 0.0f), 1.0f) * maxDepth);
+
+	uint64_t key = pass;
+	key = (key << SORT_KEY_PIPELINE_BITS) | pipeline;
+	key = (key << SORT_KEY_DESCRIPTOR_SET_BITS) | descriptorSet;
+	key = (key << SORT_KEY_MATERIAL_BITS) | material;
+	key = (key << SORT_KEY_DEPTH_BITS) | quantisedDepth;
+
+	return key;
+}
+
+// vertex and instance buffers and the index buffer, bound together whenever a draw uses different geometry from the one before
+struct RenderGeometry {
+	VkBuffer buffers[2];
+	VkDeviceSize offsets[2];
+	VkBuffer indexBuffer;
+	VkIndexType indexType;
+};
+
+// one indexed draw, the state it needs is given as indices into the queue's tables
+struct RenderDraw {
+	uint32_t pipeline;
+	uint32_t descriptorSet;
+	// selects the draw's uniforms within a set with a dynamic uniform buffer, ignored for sets without one
+	uint32_t dynamicOffset;
+	uint32_t geometry;
+	uint32_t indexCount;
+	uint32_t instanceCount;
+	uint32_t firstInstance;
+};
+
+// binds recorded by one or more replays, next to the draws which without the queue would each bind their own state
+struct RenderBindCounts {
+	uint64_t draws = 0;
+	uint64_t pipelineBinds = 0;
+	uint64_t descriptorSetBinds = 0;
+	// draws with a descriptor set, as those without one bind nothing either way
+	uint64_t descriptorSetDraws = 0;
+	uint64_t geometryBinds = 0;
+
+	void add(const RenderBindCounts& other) {
+		draws += other.draws;
+		pipelineBinds += other.pipelineBinds;
+		descriptorSetBinds += other.descriptorSetBinds;
+		descriptorSetDraws += other.descriptorSetDraws;
+		geometryBinds += other.geometryBinds;
+	}
+
+	uint64_t savedBinds() const {
+		return (draws - pipelineBinds) + (descriptorSetDraws - descriptorSetBinds) + (draws - geometryBinds);
+	}
+};
+
+// draws submitted in any order, radix sorted by key and replayed so consecutive draws sharing state skip its binds
+// filled and sorted on one thread each frame, after which any number of threads may replay disjoint ranges of it
+class RenderQueue {
+	public:
+		// drops the last frame's draws and state, keeping the memory for the next
+		void reset() {
+			pipelines.clear();
+			descriptorSets.clear();
+			geometries.clear();
+			draws.clear();
+			entries.clear();
+		}
+
+		// a pipeline added before gets its existing index, as several variants may stand in for the same fallback
+		uint32_t addPipeline(VkPipeline pipeline, VkPipelineLayout layout) {
+			for (size_t i = 0; i < pipelines.size(); i++) {
+				if (pipelines[i].pipeline == pipeline && pipelines[i].layout == layout) {
+					return static_cast<uint32_t>(i);
+				}
+			}
+
+			pipelines.push_back({pipeline, layout});
+			return static_cast<uint32_t>(pipelines.size() - 1);
+		}
+
+		// VK_NULL_HANDLE for draws whose pipeline uses no descriptor sets, dynamic sets are bound with each draw's dynamic offset
+		uint32_t addDescriptorSet(VkDescriptorSet descriptorSet, bool dynamic = false) {
+			descriptorSets.push_back({descriptorSet, dynamic});
+			return static_cast<uint32_t>(descriptorSets.size() - 1);
+		}
+
+		uint32_t addGeometry(const RenderGeometry& geometry) {
+			geometries.push_back(geometry);
+			return static_cast<uint32_t>(geometries.size() - 1);
+		}
+
+		void submit(uint64_t sortKey, const RenderDraw& draw) {
+			entries.push_back({sortKey, static_cast<uint32_t>(draws.size())});
+			draws.push_back(draw);
+		}
+
+		size_t size() const {
+			return entries.size();
+		}
+
+		// least significant digit first, 8 bits at a time, so draws with equal keys keep their submission order
+		void sort() {
+			auto sortStart = std::chrono::steady_clock::now();
+
+			size_t count = entries.size();
+			scratch.resize(count);
+
+			// every digit's histogram is counted in one pass over the keys
+			std::vector<uint32_t> histograms(8 * 256, 0);
+			for (const auto& entry : entries) {
+				for (uint32_t digit = 0; digit < 8; digit++) {
+					histograms[digit * 256 + ((entry.key >> (8 * digit)) & 0xff)]++;
+				}
+			}
+
+			for (uint32_t digit = 0; digit < 8; digit++) {
+				uint32_t* histogram = &histograms[digit * 256];
+
+				// a digit every key shares would leave the order as it is, which is common as most draws share their pass and pipeline
+				if (count == 0 || histogram[(entries[0].key >> (8 * digit)) & 0xff] == count) {
+					continue;
+				}
+
+				uint32_t offset = 0;
+				for (uint32_t bucket = 0; bucket < 256; bucket++) {
+					uint32_t bucketSize = histogram[bucket];
+					histogram[bucket] = offset;
+					offset += bucketSize;
+				}
+
+				for (const auto& entry : entries) {
+					scratch[histogram[(entry.key >> (8 * digit)) & 0xff]++] = entry;
+				}
+				entries.swap(scratch);
+			}
+
+			lastSortMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sortStart).count();
+		}
+
+		double getLastSortMs() const {
+			return lastSortMs;
+		}
+
+		// records sorted draws [begin, end), assuming nothing is bound yet as a secondary command buffer inherits no state
+		RenderBindCounts replay(VkCommandBuffer commandBuffer, size_t begin, size_t end) const {
+			RenderBindCounts counts;
+
+			const uint32_t NONE = UINT32_MAX;
+			uint32_t boundPipeline = NONE;
+			uint32_t boundDescriptorSet = NONE;
+			uint32_t boundDynamicOffset = 0;
+			uint32_t boundGeometry = NONE;
+			VkPipelineLayout boundLayout = VK_NULL_HANDLE;
+
+			for (size_t i = begin; i < end; i++) {
+				const RenderDraw& draw = draws[entries[i].draw];
+
+				if (draw.pipeline != boundPipeline) {
+					const PipelineState& pipeline = pipelines[draw.pipeline];
+					vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.pipeline);
+					boundPipeline = draw.pipeline;
+					counts.pipelineBinds++;
+
+					// sets bound through a different layout may be disturbed, so they are bound again
+					if (pipeline.layout != boundLayout) {
+						boundLayout = pipeline.layout;
+						boundDescriptorSet = NONE;
+					}
+				}
+
+				const DescriptorSetState& descriptorSet = descriptorSets[draw.descriptorSet];
+				if (descriptorSet.set != VK_NULL_HANDLE) {
+					counts.descriptorSetDraws++;
+					// draws sharing a dynamic set still bind it again when their uniforms are elsewhere
+					if (draw.descriptorSet != boundDescriptorSet || (descriptorSet.dynamic && draw.dynamicOffset != boundDynamicOffset)) {
+						vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, boundLayout, 0, 1, &descriptorSet.set, descriptorSet.dynamic ? 1 : 0, &draw.dynamicOffset);
+						boundDescriptorSet = draw.descriptorSet;
+						boundDynamicOffset = draw.dynamicOffset;
+						counts.descriptorSetBinds++;
+					}
+				}
+
+				if (draw.geometry != boundGeometry) {
+					const RenderGeometry& geometry = geometries[draw.geometry];
+					vkCmdBindVertexBuffers(commandBuffer, 0, 2, geometry.buffers, geometry.offsets);
+					vkCmdBindIndexBuffer(commandBuffer, geometry.indexBuffer, 0, geometry.indexType);
+					boundGeometry = draw.geometry;
+					counts.geometryBinds++;
+				}
+
+				vkCmdDrawIndexed(commandBuffer, draw.indexCount, draw.instanceCount, 0, 0, draw.firstInstance);
+				counts.draws++;
+			}
+
+			return counts;
+		}
+
+	private:
+		struct PipelineState {
+			VkPipeline pipeline;
+			VkPipelineLayout layout;
+		};
+
+		struct DescriptorSetState {
+			VkDescriptorSet set;
+			bool dynamic;
+		};
+
+		// sorted in place of the draws themselves, which are only read again when replayed
+		struct Entry {
+			uint64_t key;
+			uint32_t draw;
+		};
+
+		std::vector<PipelineState> pipelines;
+		std::vector<DescriptorSetState> descriptorSets;
+		std::vector<RenderGeometry> geometries;
+		std::vector<RenderDraw> draws;
+		std::vector<Entry> entries;
+		std::vector<Entry> scratch;
+		double lastSortMs = 0.0;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <map>
+#include <mutex>
+#include <fstream>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+
+// SPIR-V compiled by the makefile with glslc -mfmt=num, which writes each module as a comma separated list of words
+// uint32_t arrays are word aligned, so Vulkan reads the code straight out of the binary's read-only data
+inline constexpr uint32_t VERT_SPIRV[] = {
+#include "shaders/generated/vert.spv.inc"
+};
+
+inline constexpr uint32_t FRAG_SPIRV[] = {
+#include "shaders/generated/frag.spv.inc"
+};
+
+inline constexpr uint32_t CULL_SPIRV[] = {
+#include "shaders/generated/cull.spv.inc"
+};
+
+inline constexpr uint32_t PARTICLES_SPIRV[] = {
+#include "shaders/generated/particles.spv.inc"
+};
+
+// reads a .spv file into words rather than bytes, so the code is suitably aligned for vkCreateShaderModule
+inline std::vector<uint32_t> readSpirvFile(const std::string& path) {
+	std::ifstream file(path, std::ios::ate | std::ios::binary);
+	if (!file.is_open()) {
+		throw std::runtime_error("ERROR: Failed to open file " + path);
+	}
+
+	size_t fileSize = static_cast<size_t>(file.tellg());
+	if (fileSize % sizeof(uint32_t) != 0) {
+		throw std::runtime_error("ERROR: " + path + " is not a whole number of SPIR-V words");
+	}
+
+	std::vector<uint32_t> words(fileSize / sizeof(uint32_t));
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(words.data()), fileSize);
+
+	return words;
+}
+
+// SPIR-V owned by the binary or by a ShaderRegistry, which must outlive it
+struct ShaderCode {
+	const uint32_t* words;
+	// in bytes, as VkShaderModuleCreateInfo wants it
+	size_t size;
+};
+
+struct EmbeddedShader {
+	const char* name;
+	ShaderCode code;
+};
+
+// named after the .spv files the makefile also writes to shaders/
+inline constexpr EmbeddedShader EMBEDDED_SHADERS[] = {
+	{"vert", {VERT_SPIRV, sizeof(VERT_SPIRV)}},
+	{"frag", {FRAG_SPIRV, sizeof(FRAG_SPIRV)}},
+	{"cull", {CULL_SPIRV, sizeof(CULL_SPIRV)}},
+	{"particles", {PARTICLES_SPIRV, sizeof(PARTICLES_SPIRV)}},
+};
+
+// looks shaders up by name, from the copies embedded in the binary or, during development, from .spv files on disk
+class ShaderRegistry {
+	public:
+		// empty to use the embedded shaders, otherwise each shader is read from <directory>/<name>.spv on first use
+		void setOverrideDirectory(const std::string& directory) {
+			overrideDirectory = directory;
+		}
+
+		ShaderCode get(const std::string& name) {
+			if (overrideDirectory.empty()) {
+				for (const auto& shader : EMBEDDED_SHADERS) {
+					if (name == shader.name) {
+						return shader.code;
+					}
+				}
+
+				throw std::runtime_error("ERROR: No embedded shader named " + name);
+			}
+
+			// shaders may be looked up from several initialisation steps at once
+			std::lock_guard<std::mutex> lock(mutex);
+
+			auto loadedShader = loaded.find(name);
+			if (loadedShader == loaded.end()) {
+				loadedShader = loaded.emplace(name, readSpirvFile(overrideDirectory + "/" + name + ".spv")).first;
+			}
+
+			return {loadedShader->second.data(), loadedShader->second.size() * sizeof(uint32_t)};
+		}
+
+	private:
+		std::string overrideDirectory;
+		std::mutex mutex;
+		// map nodes never move, so codes handed out stay valid as more shaders are loaded
+		std::map<std::string, std::vector<uint32_t>> loaded;
+};
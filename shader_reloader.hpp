@@ -0,0 +1,220 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <filesystem>
+#include <chrono>
+#include <cstdlib>
+
+#include "frame_stats.hpp"
+#include "shader_registry.hpp"
+
+// how often the watcher checks the shader sources for changes, this bounds how long an edit goes unnoticed
+const std::chrono::milliseconds SHADER_WATCH_INTERVAL(250);
+
+struct ShaderSource {
+	// GLSL source which is watched for edits
+	std::string sourcePath;
+	// SPIR-V it is compiled to, and which pipelines are built from
+	std::string spirvPath;
+};
+
+struct ShaderReloadSummary {
+	uint64_t reloads = 0;
+	uint64_t failures = 0;
+	// running glslc on the changed sources
+	PercentileSummary compileMs;
+	// creating the replacement pipeline
+	PercentileSummary buildMs;
+	// from the change being noticed until the replacement pipeline is taken at a frame boundary
+	PercentileSummary reloadMs;
+};
+
+// watches GLSL sources and, when one changes, compiles it with glslc and builds a replacement pipeline on a background thread
+// the render loop picks the pipeline up with takePipeline() at a frame boundary, so it never waits on compilation
+class ShaderReloader {
+	public:
+		// builds a pipeline from the SPIR-V of every source, in the order the sources were given
+		using PipelineBuilder = std::function<VkPipeline(const std::vector<ShaderCode>&)>;
+
+		ShaderReloader() = default;
+		ShaderReloader(const ShaderReloader&) = delete;
+		ShaderReloader& operator=(const ShaderReloader&) = delete;
+
+		~ShaderReloader() {
+			stop();
+		}
+
+		void start(VkDevice logicalDevice, const std::vector<ShaderSource>& shaderSources, PipelineBuilder pipelineBuilder) {
+			device = logicalDevice;
+			sources = shaderSources;
+			builder = pipelineBuilder;
+
+			// edits made before startup are the makefile's business, only later ones are reloaded
+			for (const auto& source : sources) {
+				modifiedTimes.push_back(readModifiedTime(source.sourcePath));
+			}
+
+			// glslc from the environment, as set up by the Vulkan SDK's setup-env, otherwise from PATH
+			const char* glslcPath = std::getenv("GLSLC");
+			glslc = glslcPath != nullptr ? glslcPath : "glslc";
+
+			watcher = std::thread([this] { watchLoop(); });
+		}
+
+		// call once the device is idle, destroys a replacement that was built but never taken
+		void stop() {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				stopping = true;
+			}
+			stopCondition.notify_one();
+
+			if (watcher.joinable()) {
+				watcher.join();
+			}
+
+			if (readyPipeline != VK_NULL_HANDLE) {
+				vkDestroyPipeline(device, readyPipeline, nullptr);
+				readyPipeline = VK_NULL_HANDLE;
+			}
+		}
+
+		// the newest pipeline built since the last call, or VK_NULL_HANDLE, the caller owns it from then on
+		VkPipeline takePipeline() {
+			std::lock_guard<std::mutex> lock(mutex);
+
+			VkPipeline pipeline = readyPipeline;
+			if (pipeline != VK_NULL_HANDLE) {
+				readyPipeline = VK_NULL_HANDLE;
+				reloadMs.push(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - readyChangeTime).count());
+				reloads++;
+			}
+
+			return pipeline;
+		}
+
+		ShaderReloadSummary summarise() {
+			std::lock_guard<std::mutex> lock(mutex);
+
+			ShaderReloadSummary summary;
+			summary.reloads = reloads;
+			summary.failures = failures;
+			summary.compileMs = compileMs.summarise();
+			summary.buildMs = buildMs.summarise();
+			summary.reloadMs = reloadMs.summarise();
+
+			return summary;
+		}
+
+	private:
+		VkDevice device = VK_NULL_HANDLE;
+		std::vector<ShaderSource> sources;
+		PipelineBuilder builder;
+		std::string glslc;
+
+		// only touched by the watcher thread once it has started
+		std::vector<std::filesystem::file_time_type> modifiedTimes;
+
+		std::thread watcher;
+		std::mutex mutex;
+		std::condition_variable stopCondition;
+		bool stopping = false;
+
+		VkPipeline readyPipeline = VK_NULL_HANDLE;
+		std::chrono::steady_clock::time_point readyChangeTime;
+
+		uint64_t reloads = 0;
+		uint64_t failures = 0;
+		SampleRing compileMs;
+		SampleRing buildMs;
+		SampleRing reloadMs;
+
+		static std::filesystem::file_time_type readModifiedTime(const std::string& path) {
+			// a file being replaced by an editor may briefly not exist, which is not a change
+			std::error_code error;
+			return std::filesystem::last_write_time(path, error);
+		}
+
+		void watchLoop() {
+			while (true) {
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					if (stopCondition.wait_for(lock, SHADER_WATCH_INTERVAL, [this] { return stopping; })) {
+						return;
+					}
+				}
+
+				std::vector<size_t> changed;
+				for (size_t i = 0; i < sources.size(); i++) {
+					auto modifiedTime = readModifiedTime(sources[i].sourcePath);
+					if (modifiedTime != std::filesystem::file_time_type() && modifiedTime != modifiedTimes[i]) {
+						modifiedTimes[i] = modifiedTime;
+						changed.push_back(i);
+					}
+				}
+
+				if (!changed.empty()) {
+					reload(changed);
+				}
+			}
+		}
+
+		void reload(const std::vector<size_t>& changed) {
+			auto changeTime = std::chrono::steady_clock::now();
+
+			// a failed compile keeps the current pipeline, glslc has already printed why
+			for (size_t i : changed) {
+				std::string command = "\"" + glslc + "\" \"" + sources[i].sourcePath + "\" -o \"" + sources[i].spirvPath + "\"";
+				if (std::system(command.c_str()) != 0) {
+					std::cerr << "Shader reload: failed to compile " << sources[i].sourcePath << std::endl;
+					std::lock_guard<std::mutex> lock(mutex);
+					failures++;
+					return;
+				}
+			}
+
+			auto buildStart = std::chrono::steady_clock::now();
+			VkPipeline pipeline = VK_NULL_HANDLE;
+
+			try {
+				std::vector<std::vector<uint32_t>> words;
+				for (const auto& source : sources) {
+					words.push_back(readSpirvFile(source.spirvPath));
+				}
+
+				std::vector<ShaderCode> spirv;
+				for (const auto& code : words) {
+					spirv.push_back({code.data(), code.size() * sizeof(uint32_t)});
+				}
+				pipeline = builder(spirv);
+			}
+			catch (const std::exception& e) {
+				std::cerr << "Shader reload: " << e.what() << std::endl;
+				std::lock_guard<std::mutex> lock(mutex);
+				failures++;
+				return;
+			}
+
+			auto buildEnd = std::chrono::steady_clock::now();
+
+			std::lock_guard<std::mutex> lock(mutex);
+			compileMs.push(std::chrono::duration<double, std::milli>(buildStart - changeTime).count());
+			buildMs.push(std::chrono::duration<double, std::milli>(buildEnd - buildStart).count());
+
+			// a newer build supersedes one the render loop has not taken yet, which was never used
+			if (readyPipeline != VK_NULL_HANDLE) {
+				vkDestroyPipeline(device, readyPipeline, nullptr);
+			}
+			readyPipeline = pipeline;
+			readyChangeTime = changeTime;
+		}
+};
@@ -5,6 +5,9 @@ layout(location = 0) in vec3 fragColour;
 
 layout(location = 0) out vec4 outColour;
 
+// alpha written with the colour, only visible in pipeline variants which blend
+layout(constant_id = 0) const float OPACITY = 1.0;
+
 void main() {
-	outColour = vec4(fragColour, 1.0);
+	outColour = vec4(fragColour, OPACITY);
 }
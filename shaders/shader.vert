@@ -1,21 +1,42 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
+// for the unsized material array, every index into it is the same across a draw
+#extension GL_EXT_nonuniform_qualifier : enable
 
-layout(location = 0) out vec3 fragColour;
+// full floats, or 16 bit positions and 8 bit colours converted by the vertex fetch, see vertex_format.hpp
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColour;
+
+// per-instance attributes
+layout(location = 2) in vec2 instanceOffset;
+layout(location = 3) in float instanceScale;
+layout(location = 4) in vec4 instanceColour;
+
+// region of the scene shown in the viewport, matches ViewTransform in gpu_culling.hpp
+// followed by the mesh's dequantisation, matches VertexPushConstants in vulkan_triangle_application.hpp
+layout(push_constant) uniform View {
+	vec2 offset;
+	vec2 scale;
+	// identity unless positions were quantised to the mesh's bounds
+	vec4 positionCentre;
+	vec4 positionExtent;
+} view;
 
-vec2 positions[3] = vec2[](
-			vec2(0.0, -0.5),
-			vec2(0.5, 0.5),
-			vec2(-0.5, 0.5)
-		);
+// the draw's uniforms, selected by the dynamic offset its set is bound with, matches DrawUniforms in descriptor_table.hpp
+layout(set = 0, binding = 0) uniform Draw {
+	uint material;
+} draw;
 
-vec3 colours[3] = vec3[](
-			vec3(1.0, 0.0, 0.0),
-			vec3(0.0, 1.0, 0.0),
-			vec3(0.0, 0.0, 1.0)
-		);
+// every material registered in the bindless descriptor table
+layout(set = 1, binding = 0) readonly buffer Material {
+	vec4 colour;
+} materials[];
+
+layout(location = 0) out vec3 fragColour;
 
 void main() {
-	gl_Position = vec4(positions[gl_VertexIndex], 0.0, 1.0);
-	fragColour = colours[gl_VertexIndex];
+	vec3 meshPosition = view.positionCentre.xyz + inPosition * view.positionExtent.xyz;
+	vec2 position = meshPosition.xy * instanceScale + instanceOffset;
+	gl_Position = vec4((position - view.offset) * view.scale, meshPosition.z, 1.0);
+	fragColour = inColour * instanceColour.rgb * materials[draw.material].colour.rgb;
 }
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <map>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+
+struct StartupStepTiming {
+	std::string name;
+	double startMs; // relative to the start of the schedule
+	double durationMs;
+};
+
+// runs named startup steps on worker threads, each starting as soon as the steps it depends on have finished
+// steps must be added after their dependencies, so insertion order is always a valid serial order as well
+class StartupScheduler {
+	public:
+		explicit StartupScheduler(bool parallel) : parallel(parallel) {}
+
+		void addStep(const std::string& name, const std::vector<std::string>& dependencies, std::function<void()> function) {
+			Step step{name, {}, function};
+
+			for (const auto& dependency : dependencies) {
+				auto found = stepIndices.find(dependency);
+
+				if (found == stepIndices.end()) {
+					throw std::runtime_error("ERROR: Startup step " + name + " depends on unknown step " + dependency);
+				}
+
+				step.dependencies.push_back(found->second);
+			}
+
+			stepIndices[name] = steps.size();
+			steps.push_back(step);
+		}
+
+		void run() {
+			startTime = std::chrono::steady_clock::now();
+
+			if (!parallel) {
+				for (const auto& step : steps) {
+					runStep(step);
+				}
+				return;
+			}
+
+			std::vector<std::shared_future<void>> futures(steps.size());
+
+			for (size_t i = 0; i < steps.size(); i++) {
+				std::vector<std::shared_future<void>> dependencyFutures;
+				for (size_t dependency : steps[i].dependencies) {
+					dependencyFutures.push_back(futures[dependency]);
+				}
+
+				// a failed dependency rethrows from get(), so its dependents fail without running
+				futures[i] = std::async(std::launch::async, [this, i, dependencyFutures] {
+					for (const auto& dependencyFuture : dependencyFutures) {
+						dependencyFuture.get();
+					}
+					runStep(steps[i]);
+				}).share();
+			}
+
+			// wait for every step even after a failure, so nothing is still running when the exception reaches the caller
+			std::exception_ptr firstError;
+			for (const auto& future : futures) {
+				try {
+					future.get();
+				}
+				catch (...) {
+					if (!firstError) {
+						firstError = std::current_exception();
+					}
+				}
+			}
+
+			if (firstError) {
+				std::rethrow_exception(firstError);
+			}
+		}
+
+		// timings of every step which ran, ordered by start time
+		std::vector<StartupStepTiming> getTimings() const {
+			std::vector<StartupStepTiming> sorted = timings;
+			std::sort(sorted.begin(), sorted.end(), [](const StartupStepTiming& a, const StartupStepTiming& b) {
+				return a.startMs < b.startMs;
+			});
+			return sorted;
+		}
+
+	private:
+		struct Step {
+			std::string name;
+			std::vector<size_t> dependencies;
+			std::function<void()> function;
+		};
+
+		bool parallel;
+		std::vector<Step> steps;
+		std::map<std::string, size_t> stepIndices;
+
+		std::chrono::steady_clock::time_point startTime;
+		std::mutex timingsMutex;
+		std::vector<StartupStepTiming> timings;
+
+		void runStep(const Step& step) {
+			auto stepStart = std::chrono::steady_clock::now();
+
+			step.function();
+
+			auto stepEnd = std::chrono::steady_clock::now();
+
+			std::lock_guard<std::mutex> lock(timingsMutex);
+			timings.push_back({step.name, std::chrono::duration<double, std::milli>(stepStart - startTime).count(), std::chrono::duration<double, std::milli>(stepEnd - stepStart).count()});
+		}
+};
@@ -0,0 +1,393 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <vector>
+#include <stdexcept>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+#include "frame_stats.hpp"
+#include "frame_timeline.hpp"
+#include "gpu_buffer.hpp"
+
+// staging memory for one batch of copies, and the number of batches which may be recorded or in flight at once
+const VkDeviceSize UPLOAD_BATCH_SIZE = 8 * 1024 * 1024;
+const uint32_t UPLOAD_BATCH_COUNT = 4;
+
+struct UploadSummary {
+	// false when uploads share the graphics queue, as the device has no transfer only queue family or it was turned off
+	bool dedicatedQueue = false;
+	uint32_t queueFamily = 0;
+	uint64_t batches = 0;
+	// bytes whose copies have finished
+	uint64_t bytes = 0;
+	// bytes refused because every batch was in flight or the range was still busy, for the caller to offer again later
+	uint64_t refusedBytes = 0;
+	// from the first batch being submitted until the last one was seen to finish
+	double seconds = 0.0;
+	// from a batch being submitted until it was seen to finish, which is checked once a frame
+	PercentileSummary batchLatencyMs;
+
+	double bytesPerSecond() const {
+		return seconds > 0.0 ? bytes / seconds : 0.0;
+	}
+};
+
+// copies data into device local buffers from a transfer only queue while frames render on the graphics queue
+// copies are batched, one submission per batch, each signalling the next value of the upload timeline when it finishes
+// the next frame's command buffer takes ownership of finished batches' ranges for the graphics queue, and its submission waits on the timeline for them
+// a range stays busy from being written until the frame which acquired it has finished, so it is never written or released again while the graphics queue may still be acquiring or reading it
+// without a transfer only queue the batches are submitted to the graphics queue, with a plain barrier in place of the ownership transfer
+class UploadScheduler {
+	public:
+		// consumerStages and consumerAccess are how the graphics queue goes on to use uploaded data, frameTimeline is the one its frames signal
+		void create(GpuAllocator& gpuAllocator, VkDevice logicalDevice, FrameTimeline& frameTimeline, VkQueue uploadQueue, uint32_t uploadQueueFamily, uint32_t graphicsQueueFamily, VkPipelineStageFlags consumerStages, VkAccessFlags consumerAccess) {
+			allocator = &gpuAllocator;
+			device = logicalDevice;
+			frames = &frameTimeline;
+			queue = uploadQueue;
+			uploadFamily = uploadQueueFamily;
+			graphicsFamily = graphicsQueueFamily;
+			dstStages = consumerStages;
+			dstAccess = consumerAccess;
+
+			// batch N signals N, as frames do on the frame timeline
+			timeline.create(device);
+
+			staging = createBuffer(*allocator, device, UPLOAD_BATCH_SIZE * UPLOAD_BATCH_COUNT, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			stagingData = staging.allocation.mapped;
+
+			VkCommandPoolCreateInfo commandPoolCreateInfo{};
+			commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			commandPoolCreateInfo.queueFamilyIndex = uploadFamily;
+			commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+			if (vkCreateCommandPool(device, &commandPoolCreateInfo, nullptr, &commandPool) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to create upload scheduler command pool");
+			}
+
+			VkCommandBuffer commandBuffers[UPLOAD_BATCH_COUNT];
+
+			VkCommandBufferAllocateInfo allocateInfo{};
+			allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocateInfo.commandPool = commandPool;
+			allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			allocateInfo.commandBufferCount = UPLOAD_BATCH_COUNT;
+
+			if (vkAllocateCommandBuffers(device, &allocateInfo, commandBuffers) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to allocate upload scheduler command buffers");
+			}
+
+			for (uint32_t i = 0; i < UPLOAD_BATCH_COUNT; i++) {
+				batches[i].commandBuffer = commandBuffers[i];
+			}
+		}
+
+		// call once the device is idle
+		void destroy() {
+			if (device == VK_NULL_HANDLE) {
+				return;
+			}
+
+			vkDestroyCommandPool(device, commandPool, nullptr);
+			destroyBuffer(*allocator, device, staging);
+			timeline.destroy();
+		}
+
+		bool isDedicated() const {
+			return uploadFamily != graphicsFamily;
+		}
+
+		// copies data to destination once the batch it joins is submitted and finishes
+		// false when every batch is still in flight, or the range overlaps one uploaded before whose acquiring frame has not finished
+		// the range must not otherwise be in use by the GPU, its contents are replaced so ownership returns to the upload queue without a release
+		bool upload(VkBuffer destination, VkDeviceSize destinationOffset, const void* data, VkDeviceSize size) {
+			if (size > UPLOAD_BATCH_SIZE) {
+				throw std::runtime_error("ERROR: Upload larger than an upload batch");
+			}
+
+			if (isBusy(destination, destinationOffset, size)) {
+				refusedBytes += size;
+				return false;
+			}
+
+			if (batches[currentBatch].recording && batches[currentBatch].used + size > UPLOAD_BATCH_SIZE) {
+				submit();
+			}
+
+			Batch& batch = batches[currentBatch];
+			if (!batch.recording) {
+				// batches are reused in turn, each once its last copies have finished
+				if (batch.timelineValue != 0) {
+					collect();
+					if (batch.timelineValue != 0) {
+						refusedBytes += size;
+						return false;
+					}
+				}
+				beginBatch(batch);
+			}
+
+			VkDeviceSize stagingOffset = UPLOAD_BATCH_SIZE * currentBatch + batch.used;
+			std::memcpy(static_cast<char*>(stagingData) + stagingOffset, data, static_cast<size_t>(size));
+
+			VkBufferCopy copyRegion{};
+			copyRegion.srcOffset = stagingOffset;
+			copyRegion.dstOffset = destinationOffset;
+			copyRegion.size = size;
+			vkCmdCopyBuffer(batch.commandBuffer, staging.buffer, destination, 1, &copyRegion);
+
+			batch.ranges.push_back({destination, destinationOffset, size});
+			batch.used += size;
+			busyRanges.push_back({{destination, destinationOffset, size}, 0, 0});
+
+			return true;
+		}
+
+		// submits the batch being recorded, if any
+		void submit() {
+			Batch& batch = batches[currentBatch];
+			if (!batch.recording) {
+				return;
+			}
+
+			// released to the graphics queue family, which acquires each range with a matching barrier once the batch has finished
+			if (isDedicated()) {
+				std::vector<VkBufferMemoryBarrier> barriers = makeBarriers(batch.ranges, VK_ACCESS_TRANSFER_WRITE_BIT, 0);
+				vkCmdPipelineBarrier(batch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data(), 0, nullptr);
+			}
+
+			if (vkEndCommandBuffer(batch.commandBuffer) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to record upload batch");
+			}
+
+			batch.timelineValue = ++submittedValue;
+			for (auto& busy : busyRanges) {
+				if (busy.batchValue == 0) {
+					busy.batchValue = batch.timelineValue;
+				}
+			}
+			VkSemaphore timelineSemaphore = timeline.getSemaphore();
+
+			VkTimelineSemaphoreSubmitInfo timelineSubmitInfo{};
+			timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+			timelineSubmitInfo.signalSemaphoreValueCount = 1;
+			timelineSubmitInfo.pSignalSemaphoreValues = &batch.timelineValue;
+
+			VkSubmitInfo submitInfo{};
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+			submitInfo.pNext = &timelineSubmitInfo;
+			submitInfo.commandBufferCount = 1;
+			submitInfo.pCommandBuffers = &batch.commandBuffer;
+			submitInfo.signalSemaphoreCount = 1;
+			submitInfo.pSignalSemaphores = &timelineSemaphore;
+
+			if (vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to submit upload batch");
+			}
+
+			batch.recording = false;
+			batch.submitTime = std::chrono::steady_clock::now();
+			if (batchCount == 0) {
+				firstSubmitTime = batch.submitTime;
+			}
+			batchCount++;
+
+			currentBatch = (currentBatch + 1) % UPLOAD_BATCH_COUNT;
+		}
+
+		// records the graphics queue's side of every batch finished since the last call, outside of a render pass, in the command buffer of frame
+		// returns the upload timeline value the command buffer's submission must wait for at getWaitStages(), 0 when nothing was acquired
+		// only finished batches are acquired, so the wait is already satisfied and never holds up the frame
+		uint64_t cmdAcquire(VkCommandBuffer commandBuffer, uint64_t frame) {
+			collect();
+			if (finishedRanges.empty()) {
+				return 0;
+			}
+
+			if (isDedicated()) {
+				// the first scope chains with the submission's semaphore wait, which covers the same stages
+				std::vector<VkBufferMemoryBarrier> barriers = makeBarriers(finishedRanges, 0, dstAccess);
+				vkCmdPipelineBarrier(commandBuffer, dstStages, dstStages, 0, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data(), 0, nullptr);
+			}
+			else {
+				std::vector<VkBufferMemoryBarrier> barriers = makeBarriers(finishedRanges, VK_ACCESS_TRANSFER_WRITE_BIT, dstAccess);
+				vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, dstStages, 0, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data(), 0, nullptr);
+			}
+			finishedRanges.clear();
+
+			uint64_t waitValue = finishedValue;
+			finishedValue = 0;
+
+			// the acquired ranges stay busy until the frame acquiring them has finished
+			for (auto& busy : busyRanges) {
+				if (busy.batchValue != 0 && busy.batchValue <= waitValue && busy.acquiringFrame == 0) {
+					busy.acquiringFrame = frame;
+				}
+			}
+
+			return waitValue;
+		}
+
+		VkSemaphore getSemaphore() const {
+			return timeline.getSemaphore();
+		}
+
+		VkPipelineStageFlags getWaitStages() const {
+			return dstStages;
+		}
+
+		UploadSummary summarise() const {
+			UploadSummary summary;
+			summary.dedicatedQueue = isDedicated();
+			summary.queueFamily = uploadFamily;
+			summary.batches = batchCount;
+			summary.bytes = finishedBytes;
+			summary.refusedBytes = refusedBytes;
+			if (finishedBytes > 0) {
+				summary.seconds = std::chrono::duration<double>(lastFinishTime - firstSubmitTime).count();
+			}
+			summary.batchLatencyMs = batchLatencyMs.summarise();
+
+			return summary;
+		}
+
+	private:
+		struct UploadRange {
+			VkBuffer buffer;
+			VkDeviceSize offset;
+			VkDeviceSize size;
+		};
+
+		// a range written by a batch, batchValue is 0 while the batch is recording and acquiringFrame 0 until a frame acquires it
+		struct BusyRange {
+			UploadRange range;
+			uint64_t batchValue;
+			uint64_t acquiringFrame;
+		};
+
+		struct Batch {
+			VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+			bool recording = false;
+			// bytes of the batch's staging memory written so far
+			VkDeviceSize used = 0;
+			// the value signalled when the batch finishes, 0 unless it is in flight
+			uint64_t timelineValue = 0;
+			std::chrono::steady_clock::time_point submitTime;
+			std::vector<UploadRange> ranges;
+		};
+
+		GpuAllocator* allocator = nullptr;
+		VkDevice device = VK_NULL_HANDLE;
+		FrameTimeline* frames = nullptr;
+		VkQueue queue = VK_NULL_HANDLE;
+		uint32_t uploadFamily = 0;
+		uint32_t graphicsFamily = 0;
+		VkPipelineStageFlags dstStages = 0;
+		VkAccessFlags dstAccess = 0;
+
+		FrameTimeline timeline;
+		uint64_t submittedValue = 0;
+
+		GpuBuffer staging;
+		void* stagingData = nullptr;
+		VkCommandPool commandPool = VK_NULL_HANDLE;
+		Batch batches[UPLOAD_BATCH_COUNT];
+		uint32_t currentBatch = 0;
+
+		// ranges of finished batches not yet acquired by a frame, and the newest of those batches' timeline values
+		std::vector<UploadRange> finishedRanges;
+		uint64_t finishedValue = 0;
+		std::vector<BusyRange> busyRanges;
+
+		uint64_t batchCount = 0;
+		uint64_t finishedBytes = 0;
+		uint64_t refusedBytes = 0;
+		std::chrono::steady_clock::time_point firstSubmitTime;
+		std::chrono::steady_clock::time_point lastFinishTime;
+		SampleRing batchLatencyMs;
+
+		void beginBatch(Batch& batch) {
+			VkCommandBufferBeginInfo beginInfo{};
+			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+			if (vkBeginCommandBuffer(batch.commandBuffer, &beginInfo) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to begin recording upload batch");
+			}
+
+			// earlier batches may have written the same ranges, so their copies finish before this batch's start
+			VkMemoryBarrier barrier{};
+			barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			vkCmdPipelineBarrier(batch.commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+			batch.recording = true;
+			batch.used = 0;
+			batch.ranges.clear();
+		}
+
+		// forgets ranges whose acquiring frames have finished, then checks the rest for overlap
+		bool isBusy(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size) {
+			uint64_t completedFrame = frames->getCompletedFrame();
+			busyRanges.erase(std::remove_if(busyRanges.begin(), busyRanges.end(), [completedFrame](const BusyRange& busy) {
+				return busy.acquiringFrame != 0 && busy.acquiringFrame <= completedFrame;
+			}), busyRanges.end());
+
+			for (const auto& busy : busyRanges) {
+				if (busy.range.buffer == buffer && offset < busy.range.offset + busy.range.size && busy.range.offset < offset + size) {
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		// moves the ranges of batches which have finished onto finishedRanges, freeing the batches for reuse
+		void collect() {
+			uint64_t completedValue = timeline.getCompletedFrame();
+			auto now = std::chrono::steady_clock::now();
+
+			// batches finish in submission order, which is the order they are reused in
+			for (uint32_t i = 0; i < UPLOAD_BATCH_COUNT; i++) {
+				Batch& batch = batches[(currentBatch + i) % UPLOAD_BATCH_COUNT];
+				if (batch.timelineValue == 0 || batch.timelineValue > completedValue) {
+					continue;
+				}
+
+				finishedRanges.insert(finishedRanges.end(), batch.ranges.begin(), batch.ranges.end());
+				finishedValue = std::max(finishedValue, batch.timelineValue);
+				finishedBytes += batch.used;
+				batchLatencyMs.push(std::chrono::duration<double, std::milli>(now - batch.submitTime).count());
+				lastFinishTime = now;
+
+				batch.timelineValue = 0;
+				batch.ranges.clear();
+			}
+		}
+
+		// ownership moves between queue families only when uploads have a queue of their own
+		std::vector<VkBufferMemoryBarrier> makeBarriers(const std::vector<UploadRange>& ranges, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask) const {
+			std::vector<VkBufferMemoryBarrier> barriers;
+			barriers.reserve(ranges.size());
+
+			for (const auto& range : ranges) {
+				VkBufferMemoryBarrier barrier{};
+				barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+				barrier.srcAccessMask = srcAccessMask;
+				barrier.dstAccessMask = dstAccessMask;
+				barrier.srcQueueFamilyIndex = isDedicated() ? uploadFamily : VK_QUEUE_FAMILY_IGNORED;
+				barrier.dstQueueFamilyIndex = isDedicated() ? graphicsFamily : VK_QUEUE_FAMILY_IGNORED;
+				barrier.buffer = range.buffer;
+				barrier.offset = range.offset;
+				barrier.size = range.size;
+				barriers.push_back(barrier);
+			}
+
+			return barriers;
+		}
+};
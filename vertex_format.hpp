@@ -0,0 +1,194 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <vector>
+#include <stdexcept>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#include "geometry.hpp"
+
+// layout of a mesh's vertex buffer, chosen when the mesh is uploaded
+enum class VertexFormat {
+	// Vertex as it is, 32 bit floats throughout
+	Float,
+	// positions as 16 bit normalised integers spanning the mesh's bounds, colours as 8 bit UNORM
+	Snorm16,
+	// positions as half floats, colours as 8 bit UNORM
+	Half
+};
+
+// half the size of Vertex, the unused fourth position component keeps the colour 4 byte aligned as three component 16 bit vertex formats are optional
+struct PackedVertex {
+	uint16_t position[4];
+	// RGBA8
+	uint32_t colour;
+};
+
+static_assert(sizeof(PackedVertex) == 12, "PackedVertex must stay tightly packed");
+
+// pushed to shader.vert after the view transform, position = centre + attribute * extent
+struct VertexDequantisation {
+	float centre[4];
+	float extent[4];
+};
+
+// positions stored as they are need no dequantisation
+inline VertexDequantisation identityDequantisation() {
+	return {{0.0f, 0.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 1.0f, 1.0f}};
+}
+
+inline uint32_t getVertexStride(VertexFormat format) {
+	return format == VertexFormat::Float ? sizeof(Vertex) : sizeof(PackedVertex);
+}
+
+inline VkVertexInputBindingDescription getVertexBindingDescription(VertexFormat format) {
+	VkVertexInputBindingDescription bindingDescription = Vertex::getBindingDescription();
+	bindingDescription.stride = getVertexStride(format);
+
+	return bindingDescription;
+}
+
+// the same locations for every format, shader.vert reads vec3s either way and the vertex fetch converts
+inline std::array<VkVertexInputAttributeDescription, 2> getVertexAttributeDescriptions(VertexFormat format) {
+	std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions = Vertex::getAttributeDescriptions();
+	if (format == VertexFormat::Float) {
+		return attributeDescriptions;
+	}
+
+	attributeDescriptions[0].format = format == VertexFormat::Snorm16 ? VK_FORMAT_R16G16B16A16_SNORM : VK_FORMAT_R16G16B16A16_SFLOAT;
+	attributeDescriptions[0].offset = offsetof(PackedVertex, position);
+
+	attributeDescriptions[1].format = VK_FORMAT_R8G8B8A8_UNORM;
+	attributeDescriptions[1].offset = offsetof(PackedVertex, colour);
+
+	return attributeDescriptions;
+}
+
+// rounds to nearest even, values beyond the half range become infinity
+inline uint16_t floatToHalf(float value) {
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+
+	uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+	uint32_t floatExponent = (bits >> 23) & 0xff;
+	uint32_t mantissa = bits & 0x7fffff;
+
+	if (floatExponent == 0xff) {
+		return sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0);
+	}
+
+	int32_t exponent = static_cast<int32_t>(floatExponent) - 127 + 15;
+	if (exponent >= 31) {
+		return sign | 0x7c00;
+	}
+
+	uint32_t shift = 13;
+	uint32_t half = 0;
+	if (exponent <= 0) {
+		// too small for a normal half, shifted into the subnormal range with the implicit leading bit made explicit
+		if (exponent < -10) {
+			return sign;
+		}
+		mantissa |= 0x800000;
+		shift = static_cast<uint32_t>(14 - exponent);
+	}
+	else {
+		half = static_cast<uint32_t>(exponent) << 10;
+	}
+
+	half |= mantissa >> shift;
+	uint32_t remainder = mantissa & ((1u << shift) - 1);
+	uint32_t halfway = 1u << (shift - 1);
+	// a carry out of the mantissa correctly moves on to the next exponent
+	if (remainder > halfway || (remainder == halfway && (half & 1) != 0)) {
+		half++;
+	}
+
+	return sign | static_cast<uint16_t>(half);
+}
+
+inline uint32_t packColour(const float colour[3]) {
+	uint32_t packed = 255u << 24;
+	for (uint32_t channel = 0; channel < 3; channel++) {
+		float value = std::min(std::max(colour[channel], 0.0f), 1.0f);
+		packed |= static_cast<uint32_t>(std::lround(value * 255.0f)) << (8 * channel);
+	}
+
+	return packed;
+}
+
+// a mesh's streams laid out as its buffers hold them
+struct PackedGeometry {
+	std::vector<uint8_t> vertices;
+	std::vector<uint8_t> indices;
+	VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+	VertexDequantisation dequantisation = identityDequantisation();
+};
+
+// converts to one of the compressed formats, with 16 bit indices when every vertex can be addressed by one
+// Float needs no conversion, so its streams are uploaded straight from the source instead
+inline PackedGeometry packGeometry(const Vertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount, VertexFormat format) {
+	if (format == VertexFormat::Float) {
+		throw std::runtime_error("ERROR: Full float vertices are not packed");
+	}
+
+	PackedGeometry geometry;
+
+	if (format == VertexFormat::Snorm16 && vertexCount > 0) {
+		// quantised over the mesh's own bounding box, so precision follows the mesh's size rather than its distance from the origin
+		float minimum[3] = {vertices[0].position[0], vertices[0].position[1], vertices[0].position[2]};
+		float maximum[3] = {minimum[0], minimum[1], minimum[2]};
+		for (size_t i = 1; i < vertexCount; i++) {
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				minimum[axis] = std::min(minimum[axis], vertices[i].position[axis]);
+				maximum[axis] = std::max(maximum[axis], vertices[i].position[axis]);
+			}
+		}
+
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			geometry.dequantisation.centre[axis] = 0.5f * (minimum[axis] + maximum[axis]);
+			float extent = 0.5f * (maximum[axis] - minimum[axis]);
+			// a flat axis stores zeros, any extent decodes those to the centre
+			geometry.dequantisation.extent[axis] = extent > 0.0f ? extent : 1.0f;
+		}
+	}
+
+	geometry.vertices.resize(sizeof(PackedVertex) * vertexCount);
+	PackedVertex* packed = reinterpret_cast<PackedVertex*>(geometry.vertices.data());
+
+	for (size_t i = 0; i < vertexCount; i++) {
+		for (uint32_t axis = 0; axis < 3; axis++) {
+			if (format == VertexFormat::Snorm16) {
+				float normalised = (vertices[i].position[axis] - geometry.dequantisation.centre[axis]) / geometry.dequantisation.extent[axis];
+				normalised = std::min(std::max(normalised, -1.0f), 1.0f);
+				packed[i].position[axis] = static_cast<uint16_t>(static_cast<int16_t>(std::lround(normalised * 32767.0f)));
+			}
+			else {
+				packed[i].position[axis] = floatToHalf(vertices[i].position[axis]);
+			}
+		}
+		packed[i].position[3] = 0;
+		packed[i].colour = packColour(vertices[i].colour);
+	}
+
+	if (vertexCount <= 65536) {
+		geometry.indexType = VK_INDEX_TYPE_UINT16;
+		geometry.indices.resize(sizeof(uint16_t) * indexCount);
+		uint16_t* narrowed = reinterpret_cast<uint16_t*>(geometry.indices.data());
+		for (size_t i = 0; i < indexCount; i++) {
+			narrowed[i] = static_cast<uint16_t>(indices[i]);
+		}
+	}
+	else {
+		geometry.indices.resize(sizeof(uint32_t) * indexCount);
+		std::memcpy(geometry.indices.data(), indices, sizeof(uint32_t) * indexCount);
+	}
+
+	return geometry;
+}
@@ -0,0 +1,2911 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <set>
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+#include "app_config.hpp"
+#include "descriptor_table.hpp"
+#include "device_selection.hpp"
+#include "frame_capture.hpp"
+#include "frame_timeline.hpp"
+#include "geometry.hpp"
+#include "gpu_buffer.hpp"
+#include "gpu_culling.hpp"
+#include "gpu_profiler.hpp"
+#include "latency_probe.hpp"
+#include "mesh_file.hpp"
+#include "mesh_import.hpp"
+#include "mesh_optimizer.hpp"
+#include "particle_system.hpp"
+#include "pipeline_cache.hpp"
+#include "pipeline_variants.hpp"
+#include "render_queue.hpp"
+#include "shader_registry.hpp"
+#include "shader_reloader.hpp"
+#include "startup_scheduler.hpp"
+#include "upload_scheduler.hpp"
+#include "vertex_format.hpp"
+#include "worker_pool.hpp"
+
+// number of frames rendered in headless mode when no frame count is given, as there is no window to close
+const uint64_t HEADLESS_DEFAULT_FRAME_COUNT = 1000;
+
+// bytes of the streaming ring available to each frame in flight
+const VkDeviceSize STREAMING_RING_FRAME_SIZE = 4 * 1024 * 1024;
+
+// bytes of the uniform ring available to each frame in flight, per draw uniforms are small and written once per group of draws
+const VkDeviceSize UNIFORM_RING_FRAME_SIZE = 64 * 1024;
+
+// material colours registered in the descriptor table, groups of draws take them in turn and the first leaves colours as they are
+const float MATERIAL_COLOURS[][4] = {
+	{1.0f, 1.0f, 1.0f, 1.0f},
+	{1.0f, 0.8f, 0.6f, 1.0f},
+	{0.6f, 0.8f, 1.0f, 1.0f},
+	{0.7f, 1.0f, 0.7f, 1.0f}
+};
+
+// longest the low latency mode waits for a frame to be presented, so a hidden window cannot stall the loop indefinitely
+const uint64_t PRESENT_WAIT_TIMEOUT_NS = 100 * 1000 * 1000;
+
+const uint32_t WIDTH = 800;
+const uint32_t HEIGHT = 600;
+
+const std::vector<const char*> validationLayers = {"VK_LAYER_KHRONOS_validation"};
+const std::vector<const char*> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+
+#ifdef NDEBUG
+	const bool enableValidationLayers = false;
+#else
+	const bool enableValidationLayers = true;
+#endif
+
+inline VkResult CreateDebugUtilsMessengerEXT(VkInstance instance, const VkDebugUtilsMessengerCreateInfoEXT* pCreateInfo, const VkAllocationCallbacks* pAllocator, VkDebugUtilsMessengerEXT* pDebugMessenger) {
+	auto func = (PFN_vkCreateDebugUtilsMessengerEXT) vkGetInstanceProcAddr(instance, "vkCreateDebugUtilsMessengerEXT");
+
+	if (func != nullptr) {
+		return func(instance, pCreateInfo, pAllocator, pDebugMessenger);
+	}
+	else {
+		return VK_ERROR_EXTENSION_NOT_PRESENT;
+	}
+}
+
+inline void DestroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMessengerEXT debugMessenger, const VkAllocationCallbacks* pAllocator) {
+	auto func = (PFN_vkDestroyDebugUtilsMessengerEXT) vkGetInstanceProcAddr(instance, "vkDestroyDebugUtilsMessengerEXT");
+
+	if (func != nullptr) {
+		func(instance, debugMessenger, pAllocator);
+	}
+}
+
+struct QueueFamilyIndices {
+	std::optional<uint32_t> graphicsFamily;
+	std::optional<uint32_t> presentFamily;
+	// supports transfers but neither graphics nor compute, usually backed by the device's copy engines
+	std::optional<uint32_t> transferFamily;
+
+	bool isComplete() {
+		return graphicsFamily.has_value() && presentFamily.has_value();
+	}
+};
+
+struct SwapChainSupportDetails {
+	VkSurfaceCapabilitiesKHR capabilities;
+	std::vector<VkSurfaceFormatKHR> formats;
+	std::vector<VkPresentModeKHR> presentModes;
+};
+
+// command pools and buffers owned by one frame in flight, each pool is reset as a whole once the frame has finished on the GPU
+struct FrameCommands {
+	VkCommandPool primaryPool;
+	VkCommandBuffer primaryCommandBuffer;
+	// one pool and secondary command buffer per recording thread, as a pool may only be used by one thread at a time
+	std::vector<VkCommandPool> threadPools;
+	std::vector<VkCommandBuffer> secondaryCommandBuffers;
+};
+
+// matches the push constant block in shader.vert
+struct VertexPushConstants {
+	ViewTransform view;
+	VertexDequantisation dequantisation;
+};
+
+// swapchain resources replaced by a resize, kept alive until every frame which may still use them has finished
+struct RetiredSwapchain {
+	VkSwapchainKHR swapchain;
+	std::vector<VkImageView> imageViews;
+	std::vector<VkFramebuffer> framebuffers;
+	// number of frames submitted before the swapchain was retired
+	uint64_t retiredAtFrame;
+};
+
+struct RetiredPipeline {
+	VkPipeline pipeline;
+	// last frame recorded with the pipeline
+	uint64_t retiredAtFrame;
+};
+
+struct MeshLoadStats {
+	uint64_t vertexCount = 0;
+	uint64_t indexCount = 0;
+	// size of the vertex and index streams
+	uint64_t bytes = 0;
+	// from opening the mesh file until its streams are in device local buffers
+	double loadMs = 0.0;
+	// OBJ and glTF files are imported and optimised at startup, mesh files were already when they were converted
+	bool imported = false;
+	MeshImportStats import;
+	MeshOptimizationStats optimization;
+
+	double bytesPerSecond() const {
+		return loadMs > 0.0 ? bytes / (loadMs / 1000.0) : 0.0;
+	}
+};
+
+// what the vertex and index buffers hold, in the vertex format the geometry was uploaded in
+struct GeometryStats {
+	VertexFormat format = VertexFormat::Float;
+	uint64_t vertexCount = 0;
+	uint64_t indexCount = 0;
+	uint32_t bytesPerVertex = 0;
+	uint32_t bytesPerIndex = 0;
+
+	uint64_t bytes() const {
+		return vertexCount * bytesPerVertex + indexCount * bytesPerIndex;
+	}
+
+	// the same geometry as full float vertices and 32 bit indices
+	uint64_t fullFloatBytes() const {
+		return vertexCount * sizeof(Vertex) + indexCount * sizeof(uint32_t);
+	}
+};
+
+struct RunStatistics {
+	uint64_t framesRendered = 0;
+	double elapsedSeconds = 0.0;
+	// from entering run() until the first frame has been submitted, including window and Vulkan initialisation
+	double timeToFirstFrameMs = 0.0;
+};
+
+class VulkanTriangleApplication {
+	public:
+		VulkanTriangleApplication(const AppConfig& config) : config(config) {}
+
+		void run() {
+			runStartTime = std::chrono::steady_clock::now();
+
+			if (config.listDevices) {
+				listDevices();
+				return;
+			}
+
+			if (!config.headless) {
+				initWindow();
+			}
+			initVulkan();
+			if (config.printReport) {
+				printInitTimings();
+			}
+			mainLoop();
+			cleanup();
+		}
+
+		// percentile summaries of recent GPU frame times, CPU waits for earlier frames and pipeline statistics
+		GpuProfilerSummary getProfilerSummary() const {
+			return profiler.summarise();
+		}
+
+		// start and duration of each step of initVulkan(), ordered by start time
+		const std::vector<StartupStepTiming>& getInitTimings() const {
+			return initTimings;
+		}
+
+		const PipelineCacheStats& getPipelineCacheStats() const {
+			return pipelineCache.getStats();
+		}
+
+		const RunStatistics& getRunStatistics() const {
+			return runStatistics;
+		}
+
+		// allocator statistics captured at the end of the main loop, before resources are released
+		const GpuAllocatorStats& getMemoryStats() const {
+			return memoryStats;
+		}
+
+		// input to submit and submit to present completion of recent frames
+		LatencySummary getLatencySummary() const {
+			return latencyProbe.summarise();
+		}
+
+		// whether present completion is measured with VK_KHR_present_wait rather than approximated by the frame's GPU work finishing
+		bool isPresentWaitEnabled() const {
+			return presentWaitEnabled;
+		}
+
+		uint32_t getSwapchainImageCount() const {
+			return static_cast<uint32_t>(swapchainImages.size());
+		}
+
+		const MeshLoadStats& getMeshLoadStats() const {
+			return meshLoadStats;
+		}
+
+		const GeometryStats& getGeometryStats() const {
+			return geometryStats;
+		}
+
+		// capture counters as of the end of the main loop, once every captured frame has been written
+		const FrameCaptureStats& getCaptureStats() const {
+			return captureStats;
+		}
+
+		GpuCullingSummary getCullingSummary() const {
+			return culler.summarise();
+		}
+
+		// particles integrated per second of GPU simulation time at the median, 0 without timestamps or outside the particle scene
+		double getParticleThroughput() const {
+			PercentileSummary simulationMs = profiler.summarise().gpuComputeMs;
+			if (config.scene != Scene::Particles || simulationMs.count == 0 || simulationMs.p50 <= 0.0) {
+				return 0.0;
+			}
+
+			return config.particleCount / (simulationMs.p50 / 1000.0);
+		}
+
+		// variant counters as of the end of the main loop
+		const PipelineVariantSummary& getPipelineVariantSummary() const {
+			return pipelineVariantSummary;
+		}
+
+		// binds recorded for the last frame's draws, empty with GPU culling as its draws skip the queue
+		const RenderBindCounts& getRenderQueueBinds() const {
+			return renderQueueBinds;
+		}
+
+		PercentileSummary getRenderQueueSortMs() const {
+			return renderQueueSortMs.summarise();
+		}
+
+		DescriptorSummary getDescriptorSummary() const {
+			DescriptorSummary summary;
+			summary.perDrawSets = config.perDrawDescriptorSets;
+			summary.frame = descriptorCounts;
+			summary.tableResources = descriptorTable.getRegisteredCount();
+			summary.tableCapacity = descriptorTable.getCapacity();
+			summary.updateMs = descriptorUpdateMs.summarise();
+
+			return summary;
+		}
+
+		// upload counters, empty without --upload-mib
+		UploadSummary getUploadSummary() const {
+			return uploadScheduler.summarise();
+		}
+
+		// vertex shader invocations per second of GPU frame time at the median, 0 without timestamps or pipeline statistics
+		double getVertexThroughput() const {
+			GpuProfilerSummary summary = profiler.summarise();
+			if (summary.vertexInvocations.count == 0 || summary.gpuTimeMs.count == 0 || summary.gpuTimeMs.p50 <= 0.0) {
+				return 0.0;
+			}
+
+			return summary.vertexInvocations.p50 / (summary.gpuTimeMs.p50 / 1000.0);
+		}
+
+		std::string getDeviceName() const {
+			VkPhysicalDeviceProperties deviceProperties;
+			vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+			return deviceProperties.deviceName;
+		}
+
+		// the device the app runs on, with its score and identifiers
+		const DeviceCandidate& getSelectedDevice() const {
+			return selectedDevice;
+		}
+
+	private:
+		AppConfig config;
+
+		std::vector<StartupStepTiming> initTimings;
+		RunStatistics runStatistics;
+		std::chrono::steady_clock::time_point runStartTime;
+
+		GLFWwindow* window = nullptr;
+		VkSurfaceKHR surface = VK_NULL_HANDLE;
+
+		VkInstance instance;
+
+		VkDebugUtilsMessengerEXT debugMessenger;
+
+		VkSwapchainKHR swapchain;
+		std::vector<VkImage> swapchainImages;
+		std::vector<VkImageView> swapchainImageViews;
+		std::vector<VkFramebuffer> swapchainFramebuffers;
+		VkFormat swapchainImageFormat;
+		VkColorSpaceKHR swapchainColourSpace;
+		VkExtent2D swapchainExtent;
+
+		// backing memory for swapchainImages when they are offscreen targets rather than swapchain images
+		std::vector<GpuAllocation> offscreenImageMemory;
+		uint32_t nextOffscreenImage = 0;
+
+		VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+		DeviceCandidate selectedDevice;
+		VkDevice logicalDevice;
+
+		bool memoryBudgetEnabled = false;
+		GpuAllocator allocator;
+		GpuAllocatorStats memoryStats;
+
+		VkQueue graphicsQueue;
+		VkQueue presentQueue;
+		// a transfer only queue with --upload-mib when the device has one, otherwise the graphics queue
+		VkQueue uploadQueue = VK_NULL_HANDLE;
+		uint32_t uploadQueueFamily = 0;
+
+		VkRenderPass renderPass;
+		VkPipelineLayout pipelineLayout;
+		VkPipeline graphicsPipeline;
+		PipelineCache pipelineCache;
+
+		// compute pipeline culling instances for the indirect draws, only created with --gpu-culling
+		VkDescriptorSetLayout cullingDescriptorSetLayout = VK_NULL_HANDLE;
+		VkPipelineLayout cullingPipelineLayout = VK_NULL_HANDLE;
+		VkPipeline cullingPipeline = VK_NULL_HANDLE;
+		ShaderCode cullingShaderCode;
+		GpuCuller culler;
+
+		// compute pipeline integrating the particle scene, only created with --scene particles
+		VkDescriptorSetLayout particleDescriptorSetLayout = VK_NULL_HANDLE;
+		VkPipelineLayout particlePipelineLayout = VK_NULL_HANDLE;
+		VkPipeline particlePipeline = VK_NULL_HANDLE;
+		ShaderCode particleShaderCode;
+		ParticleSystem particles;
+
+		bool multiDrawIndirectEnabled = false;
+		bool fillModeNonSolidEnabled = false;
+		bool drawIndirectFirstInstanceEnabled = false;
+		PFN_vkCmdDrawIndexedIndirectCountKHR cmdDrawIndexedIndirectCount = nullptr;
+
+		ShaderRegistry shaders;
+		ShaderCode vertexShaderCode;
+		ShaderCode fragmentShaderCode;
+		VkShaderModule vertexShaderModule;
+		VkShaderModule fragmentShaderModule;
+
+		// the triangle, which stays on the CPU for the streamed geometry path, and is left empty when --mesh is used
+		Mesh mesh;
+		uint32_t meshIndexCount = 0;
+		float meshRadius = 0.0f;
+		VkIndexType meshIndexType = VK_INDEX_TYPE_UINT32;
+		VertexDequantisation meshDequantisation = identityDequantisation();
+		MeshLoadStats meshLoadStats;
+		GeometryStats geometryStats;
+		StagingUploader uploader;
+		GpuBuffer vertexBuffer;
+		GpuBuffer indexBuffer;
+		GpuBuffer instanceBuffer;
+		StreamingRing streamingRing;
+
+		// with --upload-mib, the source data is copied into uploadTarget every frame while frames render
+		UploadScheduler uploadScheduler;
+		std::vector<uint8_t> uploadSource;
+		GpuBuffer uploadTarget;
+		// the upload timeline value this frame's submission waits for, 0 when it acquired nothing
+		uint64_t uploadWaitValue = 0;
+
+		std::vector<FrameCommands> frameCommands;
+		WorkerPool recordingWorkers;
+
+		bool pipelineStatisticsEnabled = false;
+		GpuProfiler profiler;
+
+		std::vector<VkSemaphore> imageAvailableSemaphores;
+		std::vector<VkSemaphore> renderFinishedSemaphores;
+		FrameTimeline frameTimeline;
+		FrameCapture frameCapture;
+		FrameCaptureStats captureStats;
+		size_t currentFrame = 0;
+		// total number of frames submitted, which is also the number of the newest frame on frameTimeline
+		uint64_t frameNumber = 0;
+
+		// present ids let each frame's presentation be waited on, only with VK_KHR_present_id and VK_KHR_present_wait
+		bool presentWaitEnabled = false;
+		PFN_vkWaitForPresentKHR waitForPresent = nullptr;
+		VkPresentModeKHR activePresentMode = VK_PRESENT_MODE_FIFO_KHR;
+		// newest present id given to the current swapchain, and newest seen on screen
+		uint64_t lastPresentId = 0;
+		uint64_t lastCompletedPresentId = 0;
+		LatencyProbe latencyProbe;
+
+		bool framebufferResized = false;
+		std::vector<RetiredSwapchain> retiredSwapchains;
+		SampleRing swapchainRecreateMs{PROFILER_HISTORY_LENGTH};
+
+		// every frame's draws are submitted here and sorted before recording, so draws sharing state skip its binds
+		RenderQueue renderQueue;
+		RenderBindCounts renderQueueBinds;
+		SampleRing renderQueueSortMs{PROFILER_HISTORY_LENGTH};
+
+		// set 0 of the graphics pipeline points into the uniform ring, written once and bound at each group's dynamic offset
+		// set 1 is the bindless table every material is registered in, bound once per command buffer
+		VkDescriptorSetLayout drawDescriptorSetLayout = VK_NULL_HANDLE;
+		DrawDescriptorSets drawDescriptors;
+		DescriptorTable descriptorTable;
+		StreamingRing uniformRing;
+		VkDeviceSize uniformAlignment = 0;
+		GpuBuffer materialBuffer;
+		std::vector<uint32_t> materialIndices;
+		// this frame's uniforms for each group of draws, and with --per-draw-descriptor-sets the queue's set for each draw
+		std::vector<uint32_t> drawUniformOffsets;
+		std::vector<uint32_t> perDrawSets;
+		// the queue's pipeline for each group of draws this frame
+		std::vector<uint32_t> groupPipelines;
+		DescriptorFrameCounts descriptorCounts;
+		SampleRing descriptorUpdateMs{PROFILER_HISTORY_LENGTH};
+
+		// with --pipeline-variants, instances are drawn in groups each with its own variant of the graphics pipeline
+		PipelineVariantManager pipelineVariants;
+		std::vector<PipelineVariantDesc> pipelineVariantDescs;
+		PipelineVariantSummary pipelineVariantSummary;
+
+		ShaderReloader shaderReloader;
+		std::vector<RetiredPipeline> retiredPipelines;
+		ShaderReloadSummary shaderReloadSummary;
+
+		void initWindow() {
+			glfwInit();
+
+			// do not create OpenGL context
+			glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+			// allow window resizing, the swapchain is recreated to match
+			glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
+
+			// create WIDTH * HEIGHT sized window in windowed mode
+			window = glfwCreateWindow(WIDTH, HEIGHT, "Vulkan Triangle", nullptr, nullptr);
+
+			glfwSetWindowUserPointer(window, this);
+			glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+		}
+
+		static void framebufferResizeCallback(GLFWwindow* window, int width, int height) {
+			// not every platform reports VK_ERROR_OUT_OF_DATE_KHR after a resize, so flag it explicitly
+			auto app = reinterpret_cast<VulkanTriangleApplication*>(glfwGetWindowUserPointer(window));
+			app->framebufferResized = true;
+		}
+
+		void initVulkan() {
+			StartupScheduler scheduler(config.parallelInit);
+
+			// each step lists only the steps whose results it actually uses, everything else is free to overlap
+			scheduler.addStep("instance", {}, [this] { createInstance(); });
+			scheduler.addStep("debug messenger", {"instance"}, [this] { setupDebugMessenger(); });
+
+			// reading files needs no Vulkan objects, so it overlaps with instance and device creation
+			scheduler.addStep("shader files", {}, [this] { loadShaderCode(); });
+			scheduler.addStep("pipeline cache file", {}, [this] { pipelineCache.readCacheFile(config.pipelineCachePath); });
+
+			std::vector<std::string> physicalDeviceDependencies = {"instance", "debug messenger"};
+			if (!config.headless) {
+				scheduler.addStep("surface", {"instance"}, [this] { createSurface(); });
+				physicalDeviceDependencies.push_back("surface");
+			}
+			scheduler.addStep("physical device", physicalDeviceDependencies, [this] { choosePhysicalDevice(); });
+			scheduler.addStep("logical device", {"physical device"}, [this] { createLogicalDevice(); });
+			scheduler.addStep("allocator", {"logical device"}, [this] { allocator.create(physicalDevice, logicalDevice, memoryBudgetEnabled); });
+
+			scheduler.addStep("pipeline cache", {"logical device", "pipeline cache file"}, [this] { pipelineCache.create(physicalDevice, logicalDevice); });
+			scheduler.addStep("shader modules", {"logical device", "shader files"}, [this] { createShaderModules(); });
+
+			// the render pass and pipeline only need the swapchain format and extent, so they do not wait for the swapchain itself
+			scheduler.addStep("swapchain properties", {"physical device"}, [this] { chooseSwapchainProperties(); });
+			if (config.headless) {
+				scheduler.addStep("swapchain", {"allocator", "swapchain properties"}, [this] { createOffscreenTargets(); });
+			}
+			else {
+				scheduler.addStep("swapchain", {"logical device", "swapchain properties"}, [this] { createSwapChain(); });
+			}
+			scheduler.addStep("image views", {"swapchain"}, [this] { createImageViews(); });
+			scheduler.addStep("render pass", {"logical device", "swapchain properties"}, [this] { createRenderPass(); });
+			// the viewport is dynamic, so the pipeline depends on the swapchain format only through the render pass
+			scheduler.addStep("descriptor layouts", {"logical device"}, [this] { createDescriptorLayouts(); });
+			scheduler.addStep("graphics pipeline", {"render pass", "shader modules", "pipeline cache", "descriptor layouts"}, [this] { createGraphicsPipeline(); });
+			if (config.gpuCulling) {
+				scheduler.addStep("culling pipeline", {"logical device", "shader files", "pipeline cache"}, [this] { createCullingPipeline(); });
+			}
+			if (config.scene == Scene::Particles) {
+				scheduler.addStep("particle pipeline", {"logical device", "shader files", "pipeline cache"}, [this] { createParticlePipeline(); });
+			}
+			scheduler.addStep("framebuffers", {"image views", "render pass"}, [this] { createFramebuffers(); });
+
+			// command buffers are recorded every frame, so allocating them does not wait for the pipeline or framebuffers
+			scheduler.addStep("command pools", {"logical device"}, [this] { createCommandPools(); });
+			scheduler.addStep("profiler", {"logical device"}, [this] { createProfiler(); });
+			scheduler.addStep("command buffers", {"command pools"}, [this] { createCommandBuffers(); });
+			scheduler.addStep("sync objects", {"swapchain"}, [this] { createSyncObjects(); });
+			if (config.captureEvery > 0) {
+				scheduler.addStep("frame capture", {"allocator", "swapchain", "sync objects"}, [this] { frameCapture.create(allocator, logicalDevice, frameTimeline, swapchainImageFormat, swapchainExtent, config.captureFormat, config.captureDirectory); });
+			}
+
+			scheduler.addStep("geometry buffers", {"allocator"}, [this] { createGeometryBuffers(); });
+			scheduler.addStep("streaming ring", {"sync objects", "geometry buffers"}, [this] { createStreamingRing(); });
+			scheduler.addStep("draw descriptors", {"descriptor layouts", "allocator", "sync objects"}, [this] { createDrawDescriptors(); });
+			if (config.uploadMiB > 0) {
+				scheduler.addStep("upload scheduler", {"allocator", "sync objects"}, [this] { createUploadScheduler(); });
+			}
+			if (config.gpuCulling) {
+				scheduler.addStep("culling buffers", {"culling pipeline", "geometry buffers"}, [this] { createCuller(); });
+			}
+			if (config.scene == Scene::Particles) {
+				// the particle state is uploaded through the geometry buffers' staging uploader
+				scheduler.addStep("particles", {"particle pipeline", "geometry buffers"}, [this] { particles.create(allocator, logicalDevice, uploader, particleDescriptorSetLayout, config.particleCount); });
+			}
+
+			if (config.hotReload) {
+				// watching starts once the first pipeline exists, so its layout and render pass can be shared
+				scheduler.addStep("shader reloader", {"graphics pipeline"}, [this] { startShaderReloader(); });
+			}
+			if (config.pipelineVariants > 1) {
+				scheduler.addStep("pipeline variants", {"graphics pipeline"}, [this] { startPipelineVariants(); });
+			}
+
+			scheduler.run();
+
+			initTimings = scheduler.getTimings();
+		}
+
+		void printInitTimings() {
+			double initEndMs = 0.0;
+
+			std::cout << "Initialisation steps (" << (config.parallelInit ? "parallel" : "serial") << "):" << std::endl;
+			for (const auto& timing : initTimings) {
+				std::cout << "\t" << timing.name << ": started at " << timing.startMs << " ms, took " << timing.durationMs << " ms" << std::endl;
+				initEndMs = std::max(initEndMs, timing.startMs + timing.durationMs);
+			}
+			std::cout << "\ttotal: " << initEndMs << " ms" << std::endl;
+		}
+
+		void createInstance() {
+			if (enableValidationLayers && !checkValidationLayerSupport()) {
+				throw std::runtime_error("ERROR: Required validation layer(s) not available");
+			}
+
+			if (!checkInstanceExtensionSupport()) {
+				throw std::runtime_error("ERROR: Required extension(s) not available");
+			}
+
+			// optional struct providing parameters to optimize application
+			VkApplicationInfo appInfo{};
+			appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+			appInfo.pApplicationName = "Vulkan Triangle";
+			appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
+			appInfo.pEngineName = "No engine";
+			appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
+			appInfo.apiVersion = VK_API_VERSION_1_2; // timeline semaphores are core in 1.2, vkGetPhysicalDeviceMemoryProperties2 (1.1) is needed to read memory budgets
+
+			// required struct for instance creation
+			VkInstanceCreateInfo createInfo{};
+			createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+			createInfo.pApplicationInfo = &appInfo;
+
+			uint32_t glfwExtensionCount = 0;
+			const char** glfwExtensions;
+
+			// pass required extensions
+			std::vector<const char*> requiredExtensions = getRequiredExtensions();
+			createInfo.enabledExtensionCount = static_cast<uint32_t>(requiredExtensions.size());
+			createInfo.ppEnabledExtensionNames = requiredExtensions.data();
+
+			// pass validation layer names if enabled
+			VkDebugUtilsMessengerCreateInfoEXT debugCreateInfo;
+			if (enableValidationLayers) {
+				createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
+				createInfo.ppEnabledLayerNames = validationLayers.data();
+
+				// pass pointer to debuggerCreateInfo to allow debugging instance creation and destruction
+				populateDebugMessengerCreateInfo(debugCreateInfo);
+				createInfo.pNext = (VkDebugUtilsMessengerCreateInfoEXT*) &debugCreateInfo;
+			}
+			else {
+				createInfo.enabledLayerCount = 0;
+				createInfo.pNext = nullptr;
+			}
+
+			// create instance with specified parameters and no custom memory allocator callback
+			if (vkCreateInstance(&createInfo, nullptr, &instance) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to create instance");
+			}
+		}
+
+		std::vector<const char*> getRequiredExtensions() {
+			std::vector<const char*> extensions;
+
+			//get extensions required to interface with GLFW window, none are needed without a window
+			if (!config.headless) {
+				uint32_t glfwExtensionCount = 0;
+				const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+
+				extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+			}
+
+			if (enableValidationLayers) {
+				extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+			}
+
+			return extensions;
+		}
+
+		bool checkInstanceExtensionSupport() {
+			std::vector<const char*> requiredExtensions = getRequiredExtensions();
+
+			uint32_t availableExtensionCount = 0;
+			vkEnumerateInstanceExtensionProperties(nullptr, &availableExtensionCount, nullptr);
+
+			std::vector<VkExtensionProperties> availableExtensions(availableExtensionCount);
+			vkEnumerateInstanceExtensionProperties(nullptr, &availableExtensionCount, availableExtensions.data());
+
+			for (const auto& required : requiredExtensions) {
+				bool extensionFound = false;
+				for (const auto& available : availableExtensions) {
+					if (strcmp(required, available.extensionName) == 0) {
+						extensionFound = true;
+						break;
+					}
+				}
+
+				if (!extensionFound) {
+					std::cout << "Required extensions:" << std::endl;
+					for (const auto& required : requiredExtensions) {
+						std::cout << "\t" << required << std::endl;
+					}
+
+					std::cout << "Available extensions:" << std::endl;
+					for (const auto& available : availableExtensions) {
+						std::cout << "\t" << available.extensionName << std::endl;
+					}
+
+					return false;
+				}
+			}
+			return true;
+		}
+
+		bool checkValidationLayerSupport() {
+			uint32_t layerCount;
+			vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
+
+			std::vector<VkLayerProperties> availableLayers(layerCount);
+			vkEnumerateInstanceLayerProperties(&layerCount, availableLayers.data());
+
+			for (const char* layerName : validationLayers) {
+				bool layerFound = false;
+				for (const auto& layerProperties : availableLayers) {
+					if (strcmp(layerName, layerProperties.layerName) == 0) {
+						layerFound = true;
+						break;
+					}
+				}
+
+				if (!layerFound) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallBack(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType, const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData, void* pUserData) {
+			std::cerr << "Validation layer: " << pCallbackData->pMessage << std::endl;
+
+			return VK_FALSE;
+		}
+
+		void setupDebugMessenger() {
+			if (!enableValidationLayers) {
+				return;
+			}
+
+			VkDebugUtilsMessengerCreateInfoEXT createInfo;
+			populateDebugMessengerCreateInfo(createInfo);
+
+			if (CreateDebugUtilsMessengerEXT(instance, &createInfo, nullptr, &debugMessenger) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to set up debug messenger");
+			}
+		}
+
+		void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo) {
+			createInfo = {};
+			createInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+			//createInfo.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT; // ignore verbose general info
+			createInfo.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT; // only care about warnigs and errors
+			createInfo.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+			createInfo.pfnUserCallback = debugCallBack;
+			createInfo.pUserData = nullptr; // optional
+		}
+
+		void choosePhysicalDevice() {
+			uint32_t deviceCount = 0;
+			vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
+
+			if (deviceCount == 0) {
+				throw std::runtime_error("ERROR: Failed to find device with Vulkan support");
+			}
+
+			std::vector<DeviceCandidate> candidates = evaluateDevices();
+			selectedDevice = candidates[selectDevice(candidates, config.deviceSelector)];
+			physicalDevice = selectedDevice.device;
+		}
+
+		// every device with its score, and why the app cannot run on it where it cannot
+		std::vector<DeviceCandidate> evaluateDevices() {
+			uint32_t deviceCount = 0;
+			vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
+
+			std::vector<VkPhysicalDevice> devices(deviceCount);
+			vkEnumeratePhysicalDevices(instance, &deviceCount, devices.data());
+
+			std::vector<DeviceCandidate> candidates;
+			for (uint32_t i = 0; i < deviceCount; i++) {
+				DeviceCandidate candidate = describeDevice(devices[i], i);
+
+				// a device missing something the app needs is passed over rather than ending the search, as is one whose surface queries fail
+				try {
+					candidate.rejection = findDeviceRejection(devices[i]);
+				}
+				catch (const std::exception& e) {
+					candidate.rejection = e.what();
+				}
+
+				candidates.push_back(candidate);
+			}
+
+			return candidates;
+		}
+
+		// only the instance (and the window's surface, as presenting needs it) is created, so a device the app cannot run on can still be listed
+		void listDevices() {
+			if (!config.headless) {
+				initWindow();
+			}
+			createInstance();
+			if (!config.headless) {
+				createSurface();
+			}
+
+			std::vector<DeviceCandidate> candidates = evaluateDevices();
+			size_t chosen = candidates.size();
+			try {
+				chosen = selectDevice(candidates, config.deviceSelector);
+			}
+			catch (const std::exception& e) {
+				std::cout << e.what() << std::endl;
+			}
+
+			std::cout << "Devices (" << (config.headless ? "headless" : "windowed") << (config.deviceSelector.empty() ? "" : ", selecting " + config.deviceSelector) << "):" << std::endl;
+			for (size_t i = 0; i < candidates.size(); i++) {
+				const DeviceCandidate& candidate = candidates[i];
+				const DeviceScore& score = candidate.score;
+				std::cout << (i == chosen ? "* " : "  ") << candidate.index << ": " << candidate.name << " (" << deviceTypeName(candidate.type) << ", Vulkan " << VK_VERSION_MAJOR(candidate.apiVersion) << "." << VK_VERSION_MINOR(candidate.apiVersion) << ", " << candidate.deviceLocalBytes / (1024 * 1024) << " MiB device local) uuid " << candidate.uuid << std::endl;
+				std::cout << "    score " << score.total() << ": type " << score.type << ", memory " << score.memory << ", limits " << score.limits << ", queues " << score.queues << ", features " << score.features;
+				std::cout << (candidate.suitable() ? "" : ", not suitable: " + candidate.rejection) << std::endl;
+			}
+
+			if (!config.headless) {
+				vkDestroySurfaceKHR(instance, surface, nullptr);
+			}
+			vkDestroyInstance(instance, nullptr);
+			if (!config.headless) {
+				glfwDestroyWindow(window);
+				glfwTerminate();
+			}
+		}
+
+		// why the app cannot run on the device, empty when it can
+		std::string findDeviceRejection(VkPhysicalDevice device) {
+			// get basic device properties
+			VkPhysicalDeviceProperties deviceProperties;
+			vkGetPhysicalDeviceProperties(device, &deviceProperties);
+
+			// frames are synchronised with a timeline semaphore
+			if (deviceProperties.apiVersion < VK_API_VERSION_1_2) {
+				return "Vulkan 1.2 not supported";
+			}
+
+			// materials are read from a partially bound array of storage buffers indexed by each draw's uniforms
+			VkPhysicalDeviceVulkan12Features vulkan12Features{};
+			vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_12_FEATURES;
+			VkPhysicalDeviceFeatures2 features{};
+			features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+			features.pNext = &vulkan12Features;
+			vkGetPhysicalDeviceFeatures2(device, &features);
+
+			if (vulkan12Features.runtimeDescriptorArray != VK_TRUE || vulkan12Features.descriptorBindingPartiallyBound != VK_TRUE || features.features.shaderStorageBufferArrayDynamicIndexing != VK_TRUE) {
+				return "descriptor indexing (runtimeDescriptorArray, descriptorBindingPartiallyBound, shaderStorageBufferArrayDynamicIndexing) not supported";
+			}
+
+			// get queue families supported by device
+			QueueFamilyIndices indices = findQueueFamilies(device);
+
+			if (!indices.graphicsFamily.has_value()) {
+				return "no graphics queue family";
+			}
+			if (!indices.presentFamily.has_value()) {
+				return "no queue family can present to the surface";
+			}
+
+			// check whether device supports necessary extensions (e.g. VK_KHR_swapchain extension)
+			if (!checkDeviceExtensionSupport(device)) {
+				return "required device extension(s) not supported";
+			}
+
+			// headless rendering has no surface, so there is no swapchain support to check and any device type will do (e.g. software ICDs such as lavapipe)
+			if (config.headless) {
+				return "";
+			}
+
+			// check whether device has swapchain support appropriate for surface being used
+			SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
+			if (swapChainSupport.formats.empty() || swapChainSupport.presentModes.empty()) {
+				return "no surface formats or present modes for the surface";
+			}
+
+			// the device type no longer rules a device out, it only counts towards the device's score
+			return "";
+		}
+
+		std::vector<const char*> getRequiredDeviceExtensions() {
+			// nothing is presented when headless, so VK_KHR_swapchain is not needed
+			if (config.headless) {
+				return {};
+			}
+
+			return deviceExtensions;
+		}
+
+		bool isDeviceExtensionAvailable(VkPhysicalDevice device, const char* extensionName) {
+			uint32_t extensionCount;
+			vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+			std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+			vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+			for (const auto& extension : availableExtensions) {
+				if (strcmp(extension.extensionName, extensionName) == 0) {
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		bool checkDeviceExtensionSupport(VkPhysicalDevice device) {
+			uint32_t extensionCount;
+			vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+			std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+			vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+			std::vector<const char*> requiredDeviceExtensions = getRequiredDeviceExtensions();
+			std::set<std::string> requiredExtensions(requiredDeviceExtensions.begin(), requiredDeviceExtensions.end());
+
+			for (const auto& extension : availableExtensions) {
+				requiredExtensions.erase(extension.extensionName);
+			}
+
+			return requiredExtensions.empty();
+		}
+
+		QueueFamilyIndices findQueueFamilies(VkPhysicalDevice device) {
+			QueueFamilyIndices indices;
+
+			uint32_t queueFamilyCount = 0;
+			vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
+
+			// query queue family types supported by specified device
+			std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+			vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
+
+			// find at least one queue family that supports VK_QUEUE_GRAPHICS_BIT and WSI
+			int i = 0;
+			for (const auto& queueFamily : queueFamilies) {
+				if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+					indices.graphicsFamily = i;
+				}
+
+				VkBool32 presentSupport = false;
+				if (config.headless) {
+					// nothing is presented when headless, so the graphics queue stands in for the present queue
+					presentSupport = (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) ? VK_TRUE : VK_FALSE;
+				}
+				else {
+					vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+				}
+
+				if (presentSupport) {
+					indices.presentFamily = i;
+				}
+
+				if (indices.isComplete()) {
+					break;
+				}
+
+				i++;
+			}
+
+			for (uint32_t j = 0; j < queueFamilyCount; j++) {
+				VkQueueFlags flags = queueFamilies[j].queueFlags;
+				if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+					indices.transferFamily = j;
+					break;
+				}
+			}
+
+			return indices;
+		}
+
+		SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice device) {
+			SwapChainSupportDetails details;
+
+			vkGetPhysicalDeviceSurfaceCapabilitiesKHR(device, surface, &details.capabilities);
+
+			// query surface formats supported by specified device
+			uint32_t formatCount;
+			vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &formatCount, nullptr);
+
+			if (formatCount != 0) {
+				details.formats.resize(formatCount);
+				vkGetPhysicalDeviceSurfaceFormatsKHR(device, surface, &formatCount, details.formats.data());
+			}
+			else {
+				throw std::runtime_error("ERROR: Failed to retrieve surface format details");
+			}
+
+			// query present modes supported by specified device
+			uint32_t presentModeCount;
+			vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface, &presentModeCount, nullptr);
+
+			if (presentModeCount != 0) {
+				details.presentModes.resize(presentModeCount);
+				vkGetPhysicalDeviceSurfacePresentModesKHR(device, surface, &presentModeCount, details.presentModes.data());
+			}
+			else {
+				throw std::runtime_error("ERROR: Failed to retrieve present mode details");
+			}
+
+			return details;
+		}
+
+		void createLogicalDevice() {
+			QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
+
+			std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
+			std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily.value(), indices.presentFamily.value()};
+			bool dedicatedUploads = config.uploadMiB > 0 && config.transferQueue && indices.transferFamily.has_value();
+			if (dedicatedUploads) {
+				uniqueQueueFamilies.insert(indices.transferFamily.value());
+			}
+
+			// populate queue creation struct
+			float queuePriority = 1.0f;
+			for (uint32_t queueFamily : uniqueQueueFamilies) {
+			VkDeviceQueueCreateInfo queueCreateInfo{};
+				queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+				queueCreateInfo.queueFamilyIndex = queueFamily;
+				queueCreateInfo.queueCount = 1;
+				queueCreateInfo.pQueuePriorities = &queuePriority;
+				queueCreateInfos.push_back(queueCreateInfo);
+			}
+
+			// pipeline statistics queries are optional, the profiler only records timestamps without them
+			VkPhysicalDeviceFeatures supportedFeatures;
+			vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+
+			VkPhysicalDeviceFeatures deviceFeatures{};
+			deviceFeatures.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
+
+			// needed for culled draws, which are many indirect draws each selecting its instance with firstInstance
+			deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+			deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+			multiDrawIndirectEnabled = supportedFeatures.multiDrawIndirect == VK_TRUE;
+			drawIndirectFirstInstanceEnabled = supportedFeatures.drawIndirectFirstInstance == VK_TRUE;
+			pipelineStatisticsEnabled = supportedFeatures.pipelineStatisticsQuery == VK_TRUE;
+
+			// secondary command buffers run inside the frame's statistics query, which they can only do by inheriting it
+			if (config.recordThreads > 1) {
+				deviceFeatures.inheritedQueries = supportedFeatures.inheritedQueries;
+				pipelineStatisticsEnabled = pipelineStatisticsEnabled && supportedFeatures.inheritedQueries == VK_TRUE;
+			}
+
+			// required by findDeviceRejection, shader.vert indexes the material table by the draw's uniforms
+			deviceFeatures.shaderStorageBufferArrayDynamicIndexing = VK_TRUE;
+
+			// optional, pipeline variants only draw edges with it
+			deviceFeatures.fillModeNonSolid = supportedFeatures.fillModeNonSolid;
+			fillModeNonSolidEnabled = supportedFeatures.fillModeNonSolid == VK_TRUE;
+
+			// popuate logical device creation struct
+			VkDeviceCreateInfo createInfo{};
+			createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+
+			createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
+			createInfo.pQueueCreateInfos = queueCreateInfos.data();
+
+			createInfo.pEnabledFeatures = &deviceFeatures;
+
+			// push required device extensions
+			std::vector<const char*> requiredDeviceExtensions = getRequiredDeviceExtensions();
+
+			// memory budgets are optional, the allocator falls back to heap sizes and its own usage without them
+			VkPhysicalDeviceProperties deviceProperties;
+			vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+			memoryBudgetEnabled = deviceProperties.apiVersion >= VK_API_VERSION_1_1 && isDeviceExtensionAvailable(physicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+			if (memoryBudgetEnabled) {
+				requiredDeviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+			}
+
+			// present wait is optional, without it present completion is approximated by the frame finishing on the frame timeline
+			VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{};
+			presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+			VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{};
+			presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+			presentIdFeatures.pNext = &presentWaitFeatures;
+
+			if (!config.headless && deviceProperties.apiVersion >= VK_API_VERSION_1_1 && isDeviceExtensionAvailable(physicalDevice, VK_KHR_PRESENT_ID_EXTENSION_NAME) && isDeviceExtensionAvailable(physicalDevice, VK_KHR_PRESENT_WAIT_EXTENSION_NAME)) {
+				VkPhysicalDeviceFeatures2 supportedFeatures2{};
+				supportedFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+				supportedFeatures2.pNext = &presentIdFeatures;
+				vkGetPhysicalDeviceFeatures2(physicalDevice, &supportedFeatures2);
+
+				presentWaitEnabled = presentIdFeatures.presentId == VK_TRUE && presentWaitFeatures.presentWait == VK_TRUE;
+			}
+			// timeline semaphores are required of every Vulkan 1.2 device, the descriptor indexing features were checked by findDeviceRejection
+			VkPhysicalDeviceVulkan12Features vulkan12Features{};
+			vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_12_FEATURES;
+			vulkan12Features.timelineSemaphore = VK_TRUE;
+			vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+			vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+			createInfo.pNext = &vulkan12Features;
+
+			if (presentWaitEnabled) {
+				requiredDeviceExtensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+				requiredDeviceExtensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+				// the queried features are chained as they are, so both are enabled
+				vulkan12Features.pNext = &presentIdFeatures;
+			}
+
+			// a GPU written draw count lets culled draws be skipped entirely instead of drawn with no instances
+			bool drawIndirectCountEnabled = config.gpuCulling && isDeviceExtensionAvailable(physicalDevice, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+			if (drawIndirectCountEnabled) {
+				requiredDeviceExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+			}
+
+			createInfo.enabledExtensionCount = static_cast<uint32_t>(requiredDeviceExtensions.size());
+			createInfo.ppEnabledExtensionNames = requiredDeviceExtensions.data();
+
+			if (enableValidationLayers) {
+				createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
+				createInfo.ppEnabledLayerNames = validationLayers.data();
+			}
+			else {
+				createInfo.enabledLayerCount = 0;
+			}
+
+			if (vkCreateDevice(physicalDevice, &createInfo, nullptr, &logicalDevice) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to create logical device");
+			}
+
+			// get queue handles
+			vkGetDeviceQueue(logicalDevice, indices.graphicsFamily.value(), 0, &graphicsQueue);
+			vkGetDeviceQueue(logicalDevice, indices.presentFamily.value(), 0, &presentQueue);
+
+			// without a transfer only family, uploads are submitted to the graphics queue between frames
+			uploadQueue = graphicsQueue;
+			uploadQueueFamily = indices.graphicsFamily.value();
+			if (dedicatedUploads) {
+				vkGetDeviceQueue(logicalDevice, indices.transferFamily.value(), 0, &uploadQueue);
+				uploadQueueFamily = indices.transferFamily.value();
+			}
+
+			if (drawIndirectCountEnabled) {
+				cmdDrawIndexedIndirectCount = (PFN_vkCmdDrawIndexedIndirectCountKHR) vkGetDeviceProcAddr(logicalDevice, "vkCmdDrawIndexedIndirectCountKHR");
+			}
+			if (presentWaitEnabled) {
+				waitForPresent = (PFN_vkWaitForPresentKHR) vkGetDeviceProcAddr(logicalDevice, "vkWaitForPresentKHR");
+			}
+		}
+
+		void createSurface() {
+			// use GLFW to avoid platform specific window surface creation
+			if (glfwCreateWindowSurface(instance, window, nullptr, &surface) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to create window surface");
+			}
+		}
+
+		VkSurfaceFormatKHR chooseSwapchainSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats) {
+			// check available formats for one that supports SRGB
+			for (const auto& availableFormat : availableFormats) {
+				if (availableFormat.format == VK_FORMAT_B8G8R8A8_SRGB && availableFormat.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
+					return availableFormat;
+				}
+			}
+
+			return availableFormats[0]; // return first available format if none support SRGB
+		}
+
+		VkPresentModeKHR chooseSwapchainPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes) {
+			// check available present modes for the requested one, by default Mailbox which can be used to implement triple buffering
+			for (const auto& availablePresentMode : availablePresentModes) {
+				if (availablePresentMode == config.presentMode) {
+					return availablePresentMode;
+				}
+			}
+
+			return VK_PRESENT_MODE_FIFO_KHR; // use FIFO if requested mode unavailable, as it is always supported
+		}
+
+		VkExtent2D chooseSwapchainExtent(const VkSurfaceCapabilitiesKHR& capabilities) {
+			if (capabilities.currentExtent.width != UINT32_MAX) {
+				return capabilities.currentExtent;
+			}
+			else {
+				// the window may have been resized since it was created, so use its current size in pixels
+				int width, height;
+				glfwGetFramebufferSize(window, &width, &height);
+
+				VkExtent2D actualExtent = {static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
+
+				// clamp extent width and height to values supported by surface
+				actualExtent.width = std::clamp(actualExtent.width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
+				actualExtent.height = std::clamp(actualExtent.height, capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
+
+				return actualExtent;
+			}
+		}
+
+		void chooseSwapchainProperties() {
+			if (config.headless) {
+				// without a surface there is nothing to negotiate, so use a format every implementation supports as a colour attachment
+				swapchainImageFormat = VK_FORMAT_B8G8R8A8_SRGB;
+				swapchainColourSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+				swapchainExtent = {WIDTH, HEIGHT};
+				return;
+			}
+
+			SwapChainSupportDetails swapChainSupport = querySwapChainSupport(physicalDevice);
+
+			VkSurfaceFormatKHR surfaceFormat = chooseSwapchainSurfaceFormat(swapChainSupport.formats);
+
+			// store image format and extent in member variables for future use
+			swapchainImageFormat = surfaceFormat.format;
+			swapchainColourSpace = surfaceFormat.colorSpace;
+			swapchainExtent = chooseSwapchainExtent(swapChainSupport.capabilities);
+		}
+
+		// layout rendered images are left in by the render pass
+		VkImageLayout getFinalImageLayout() const {
+			// offscreen targets are never presented, so leave them ready to be read back instead
+			return config.headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		}
+
+		void createSwapChain(VkSwapchainKHR oldSwapchain = VK_NULL_HANDLE) {
+			SwapChainSupportDetails swapChainSupport = querySwapChainSupport(physicalDevice);
+
+			VkPresentModeKHR presentMode = chooseSwapchainPresentMode(swapChainSupport.presentModes);
+			activePresentMode = presentMode;
+
+			// by default use the supported minimum + 1 to avoid stalling, a requested count is raised to the minimum, and neither may exceed the maximum
+			uint32_t imageCount = swapChainSupport.capabilities.minImageCount +1;
+			if (config.swapchainImageCount > 0) {
+				imageCount = std::max(config.swapchainImageCount, swapChainSupport.capabilities.minImageCount);
+			}
+
+			if (swapChainSupport.capabilities.maxImageCount > 0 && imageCount > swapChainSupport.capabilities.maxImageCount) {
+				imageCount = swapChainSupport.capabilities.maxImageCount;
+			}
+
+			// populate swapchain creation struct with specified values
+			VkSwapchainCreateInfoKHR createInfo{};
+			createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+			createInfo.surface = surface;
+
+			createInfo.minImageCount = imageCount;
+			createInfo.imageFormat = swapchainImageFormat;
+			createInfo.imageColorSpace = swapchainColourSpace;
+			createInfo.imageExtent = swapchainExtent;
+			createInfo.imageArrayLayers = 1; // always 1 unless developing stereoscopic 3D application
+			createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+			// captured frames are copied out of the swapchain images
+			if (config.captureEvery > 0) {
+				if ((swapChainSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) == 0) {
+					throw std::runtime_error("ERROR: Frame capture not supported as swapchain images cannot be copied from");
+				}
+				createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+			}
+
+			QueueFamilyIndices indices = findQueueFamilies(physicalDevice);
+			uint32_t queueFamilyIndices[] = {indices.graphicsFamily.value(), indices.presentFamily.value()};
+
+			if (indices.graphicsFamily != indices.presentFamily) {
+				// images need not be explicitly transferred between queue families
+				createInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
+				createInfo.queueFamilyIndexCount = 2;
+				createInfo.pQueueFamilyIndices = queueFamilyIndices;
+			}
+			else {
+				// images are owned by one queue family at a time and must be transferred explicitly
+				createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+				createInfo.queueFamilyIndexCount = 0; // optional
+				createInfo.pQueueFamilyIndices = nullptr; // optional
+			}
+
+			// transforms (e.g. rotation, flipping) can be applied to images in the swapchain, currentTransform specifies no transform
+			createInfo.preTransform = swapChainSupport.capabilities.currentTransform;
+
+			createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR; // ignore alpha channel
+
+			createInfo.presentMode = presentMode;
+
+			createInfo.clipped = VK_TRUE;
+			// passing the swapchain being replaced lets the presentation engine hand its resources over, so presentation keeps flowing during a resize
+			createInfo.oldSwapchain = oldSwapchain;
+
+			if (vkCreateSwapchainKHR(logicalDevice, &createInfo, nullptr, &swapchain) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to create swapchain");
+			}
+
+			// retrieve images from swapchain and store in vector
+			vkGetSwapchainImagesKHR(logicalDevice, swapchain, &imageCount, nullptr);
+			swapchainImages.resize(imageCount);
+			vkGetSwapchainImagesKHR(logicalDevice, swapchain, &imageCount, swapchainImages.data());
+		}
+
+		void createOffscreenTargets() {
+			// by default one more target than frames in flight so the CPU rarely waits on an image
+			uint32_t imageCount = config.swapchainImageCount > 0 ? config.swapchainImageCount : config.framesInFlight + 1;
+			swapchainImages.resize(imageCount);
+			offscreenImageMemory.resize(imageCount);
+
+			// create a ring of images to stand in for the swapchain images
+			for (size_t i = 0; i < swapchainImages.size(); i++) {
+				VkImageCreateInfo imageCreateInfo{};
+				imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+				imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+				imageCreateInfo.format = swapchainImageFormat;
+				imageCreateInfo.extent = {swapchainExtent.width, swapchainExtent.height, 1};
+				imageCreateInfo.mipLevels = 1;
+				imageCreateInfo.arrayLayers = 1;
+				imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+				imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+				imageCreateInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT; // transfer source so rendered frames can be read back
+				imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+				imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+				if (vkCreateImage(logicalDevice, &imageCreateInfo, nullptr, &swapchainImages[i]) != VK_SUCCESS) {
+					throw std::runtime_error("ERROR: Failed to create offscreen image");
+				}
+
+				VkMemoryRequirements memoryRequirements;
+				vkGetImageMemoryRequirements(logicalDevice, swapchainImages[i], &memoryRequirements);
+
+				offscreenImageMemory[i] = allocator.allocate(memoryRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, ResourceKind::OptimalImage);
+
+				vkBindImageMemory(logicalDevice, swapchainImages[i], offscreenImageMemory[i].memory, offscreenImageMemory[i].offset);
+			}
+		}
+
+		uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
+			return findMemoryTypeIndex(physicalDevice, typeFilter, properties);
+		}
+
+		void createImageViews() {
+			swapchainImageViews.resize(swapchainImages.size());
+
+			// create an image view for every image in the swapchain
+			for (size_t i = 0; i < swapchainImages.size(); i++) {
+				VkImageViewCreateInfo createInfo{};
+
+				createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+				createInfo.image = swapchainImages[i];
+
+				createInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+				createInfo.format = swapchainImageFormat;
+
+				createInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+				createInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+				createInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+				createInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+
+				createInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+				createInfo.subresourceRange.baseMipLevel = 0;
+				createInfo.subresourceRange.levelCount = 1;
+				createInfo.subresourceRange.baseArrayLayer = 0;
+				createInfo.subresourceRange.layerCount = 1;
+
+				if (vkCreateImageView(logicalDevice, &createInfo, nullptr, &swapchainImageViews[i]) != VK_SUCCESS) {
+					throw std::runtime_error("ERROR: Failed to create image view");
+				}
+			}
+		}
+
+		void loadShaderCode() {
+			// compiled shader bytecode is embedded in the binary, unless --shader-dir points at .spv files to use instead
+			shaders.setOverrideDirectory(config.shaderDirectory);
+
+			vertexShaderCode = shaders.get("vert");
+			fragmentShaderCode = shaders.get("frag");
+
+			if (config.gpuCulling) {
+				cullingShaderCode = shaders.get("cull");
+			}
+			if (config.scene == Scene::Particles) {
+				particleShaderCode = shaders.get("particles");
+			}
+		}
+
+		void createShaderModules() {
+			vertexShaderModule = createShaderModule(vertexShaderCode);
+			fragmentShaderModule = createShaderModule(fragmentShaderCode);
+		}
+
+		void createGraphicsPipeline() {
+			// pipeline layout creation
+			// the view transform and the mesh's dequantisation are pushed with every frame's draws
+			VkPushConstantRange viewPushConstantRange{};
+			viewPushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+			viewPushConstantRange.offset = 0;
+			viewPushConstantRange.size = sizeof(VertexPushConstants);
+
+			// each draw's uniforms, then the material table
+			VkDescriptorSetLayout setLayouts[2] = {drawDescriptorSetLayout, descriptorTable.getLayout()};
+
+			VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+			pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+			pipelineLayoutCreateInfo.setLayoutCount = 2;
+			pipelineLayoutCreateInfo.pSetLayouts = setLayouts;
+			pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+			pipelineLayoutCreateInfo.pPushConstantRanges = &viewPushConstantRange;
+
+			if (vkCreatePipelineLayout(logicalDevice, &pipelineLayoutCreateInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to create graphics pipeline layout");
+			}
+
+			auto compileStart = std::chrono::steady_clock::now();
+
+			graphicsPipeline = buildGraphicsPipeline(vertexShaderModule, fragmentShaderModule, PipelineVariantDesc());
+
+			pipelineCache.recordCompileTime(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - compileStart).count());
+
+			// clean up shader module objects, unless variants will be built from them later
+			if (config.pipelineVariants == 1) {
+				vkDestroyShaderModule(logicalDevice, fragmentShaderModule, nullptr);
+				vkDestroyShaderModule(logicalDevice, vertexShaderModule, nullptr);
+			}
+		}
+
+		// variant 0 is the default pipeline, the bits of higher indices turn off culling, blend at half opacity and draw edges only
+		PipelineVariantDesc makePipelineVariant(uint32_t index) const {
+			PipelineVariantDesc desc;
+
+			if ((index & 1) != 0) {
+				desc.cullMode = VK_CULL_MODE_NONE;
+			}
+			if ((index & 2) != 0) {
+				desc.blendEnable = true;
+				// OPACITY in shader.frag
+				desc.constants.push_back({VK_SHADER_STAGE_FRAGMENT_BIT, 0, specializationFloat(0.5f)});
+			}
+			// edges need fillModeNonSolid, without it the variant is the same as the filled one
+			if ((index & 4) != 0 && fillModeNonSolidEnabled) {
+				desc.polygonMode = VK_POLYGON_MODE_LINE;
+			}
+
+			return desc;
+		}
+
+		void startPipelineVariants() {
+			for (uint32_t i = 0; i < config.pipelineVariants; i++) {
+				pipelineVariantDescs.push_back(makePipelineVariant(i));
+			}
+
+			// runs on the compile threads, the shader modules and everything else it touches are immutable once the default pipeline exists
+			pipelineVariants.start(logicalDevice, [this](const PipelineVariantDesc& desc) {
+				return buildGraphicsPipeline(vertexShaderModule, fragmentShaderModule, desc);
+			});
+		}
+
+		// the layout, vertex input and render pass are fixed, so shader reloads and pipeline variants can build pipelines from here on any thread
+		VkPipeline buildGraphicsPipeline(VkShaderModule vertexModule, VkShaderModule fragmentModule, const PipelineVariantDesc& desc) {
+			std::vector<VkSpecializationMapEntry> vertexConstantEntries;
+			std::vector<uint32_t> vertexConstantData;
+			VkSpecializationInfo vertexSpecializationInfo = desc.getSpecializationInfo(VK_SHADER_STAGE_VERTEX_BIT, vertexConstantEntries, vertexConstantData);
+
+			std::vector<VkSpecializationMapEntry> fragmentConstantEntries;
+			std::vector<uint32_t> fragmentConstantData;
+			VkSpecializationInfo fragmentSpecializationInfo = desc.getSpecializationInfo(VK_SHADER_STAGE_FRAGMENT_BIT, fragmentConstantEntries, fragmentConstantData);
+
+			// vertex shader stage creation
+			VkPipelineShaderStageCreateInfo vertexShaderStageCreateInfo{};
+			vertexShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+			vertexShaderStageCreateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+			vertexShaderStageCreateInfo.module = vertexModule;
+			vertexShaderStageCreateInfo.pName = "main"; // entrypoint
+			vertexShaderStageCreateInfo.pSpecializationInfo = &vertexSpecializationInfo;
+
+			// fragment shader stage creation
+			VkPipelineShaderStageCreateInfo fragmentShaderStageCreateInfo{};
+			fragmentShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+			fragmentShaderStageCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+			fragmentShaderStageCreateInfo.module = fragmentModule;
+			fragmentShaderStageCreateInfo.pName = "main"; // entrypoint
+			fragmentShaderStageCreateInfo.pSpecializationInfo = &fragmentSpecializationInfo;
+
+			VkPipelineShaderStageCreateInfo shaderStages[] = {vertexShaderStageCreateInfo, fragmentShaderStageCreateInfo};
+
+			// per-vertex data at binding 0 in the configured vertex format, per-instance data at binding 1
+			std::vector<VkVertexInputBindingDescription> bindingDescriptions = {getVertexBindingDescription(config.vertexFormat), InstanceData::getBindingDescription()};
+
+			std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
+			for (const auto& attribute : getVertexAttributeDescriptions(config.vertexFormat)) {
+				attributeDescriptions.push_back(attribute);
+			}
+			for (const auto& attribute : InstanceData::getAttributeDescriptions()) {
+				attributeDescriptions.push_back(attribute);
+			}
+
+			VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+			vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+			vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
+			vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
+			vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+			vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+
+			// input assembly configuration
+			VkPipelineInputAssemblyStateCreateInfo inputAssemblyCreateInfo{};
+			inputAssemblyCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+			inputAssemblyCreateInfo.topology = desc.topology;
+			inputAssemblyCreateInfo.primitiveRestartEnable = VK_FALSE;
+
+			// viewport configuration, the viewport and scissor themselves are dynamic state set when recording so a resize never needs a new pipeline
+			VkPipelineViewportStateCreateInfo viewportStateCreateInfo{};
+			viewportStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+			viewportStateCreateInfo.viewportCount = 1;
+			viewportStateCreateInfo.pViewports = nullptr;
+			viewportStateCreateInfo.scissorCount = 1;
+			viewportStateCreateInfo.pScissors = nullptr;
+
+			// rasterizer configuration
+			VkPipelineRasterizationStateCreateInfo rasterizerCreateInfo{};
+			rasterizerCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+			rasterizerCreateInfo.depthClampEnable = VK_FALSE; // if VK_TRUE fragments beyond near and far planes are clamped instead of discarded
+			rasterizerCreateInfo.rasterizerDiscardEnable = VK_FALSE; // if VK_TRUE geometry never passes through rasterizer stage
+			rasterizerCreateInfo.polygonMode = desc.polygonMode; // fill each polygon with fragments, or only its edges
+			rasterizerCreateInfo.lineWidth = 1.0f;
+			rasterizerCreateInfo.cullMode = desc.cullMode;
+			rasterizerCreateInfo.frontFace = desc.frontFace;
+			rasterizerCreateInfo.depthBiasEnable = VK_FALSE;
+			rasterizerCreateInfo.depthBiasConstantFactor = 0.0f;
+			rasterizerCreateInfo.depthBiasClamp = 0.0f;
+			rasterizerCreateInfo.depthBiasSlopeFactor = 0.0f;
+
+			// multisampling configuration
+			VkPipelineMultisampleStateCreateInfo multiSamplingCreateInfo{};
+			multiSamplingCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+			multiSamplingCreateInfo.sampleShadingEnable = VK_FALSE;
+			multiSamplingCreateInfo.rasterizationSamples = desc.samples;
+			multiSamplingCreateInfo.minSampleShading = 1.0f;
+			multiSamplingCreateInfo.pSampleMask = nullptr;
+			multiSamplingCreateInfo.alphaToCoverageEnable = VK_FALSE;
+			multiSamplingCreateInfo.alphaToOneEnable = VK_FALSE;
+
+			// colour blending configuration
+			VkPipelineColorBlendAttachmentState colourBlendAttachment{};
+			colourBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+			colourBlendAttachment.blendEnable = desc.blendEnable ? VK_TRUE : VK_FALSE;
+			colourBlendAttachment.srcColorBlendFactor = desc.blendEnable ? VK_BLEND_FACTOR_SRC_ALPHA : VK_BLEND_FACTOR_ONE;
+			colourBlendAttachment.dstColorBlendFactor = desc.blendEnable ? VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA : VK_BLEND_FACTOR_ZERO;
+			colourBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+			colourBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+			colourBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+			colourBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+			VkPipelineColorBlendStateCreateInfo colourBlendCreateInfo{};
+			colourBlendCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+			colourBlendCreateInfo.logicOpEnable = VK_FALSE;
+			colourBlendCreateInfo.logicOp = VK_LOGIC_OP_COPY;
+			colourBlendCreateInfo.attachmentCount = 1;
+			colourBlendCreateInfo.pAttachments = &colourBlendAttachment;
+			colourBlendCreateInfo.blendConstants[0] = 0.0f;
+			colourBlendCreateInfo.blendConstants[1] = 0.0f;
+			colourBlendCreateInfo.blendConstants[2] = 0.0f;
+			colourBlendCreateInfo.blendConstants[3] = 0.0f;
+
+			// dynamic state configuration
+			VkDynamicState dynamicStates[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR}; // some states of the pipeline can be dynamically changed without creating a new pipeline (e.g. viewport size, line width)
+			VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo{};
+			dynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+			dynamicStateCreateInfo.dynamicStateCount = 2;
+			dynamicStateCreateInfo.pDynamicStates = dynamicStates;
+
+			// pipeline creation
+			VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo{};
+			graphicsPipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+			graphicsPipelineCreateInfo.stageCount = 2;
+			graphicsPipelineCreateInfo.pStages = shaderStages;
+
+			graphicsPipelineCreateInfo.pVertexInputState = &vertexInputInfo;
+			graphicsPipelineCreateInfo.pInputAssemblyState = &inputAssemblyCreateInfo;
+			graphicsPipelineCreateInfo.pViewportState = &viewportStateCreateInfo;
+			graphicsPipelineCreateInfo.pRasterizationState = &rasterizerCreateInfo;
+			graphicsPipelineCreateInfo.pMultisampleState = &multiSamplingCreateInfo;
+			graphicsPipelineCreateInfo.pDepthStencilState = nullptr;
+			graphicsPipelineCreateInfo.pColorBlendState = &colourBlendCreateInfo;
+			graphicsPipelineCreateInfo.pDynamicState = &dynamicStateCreateInfo;
+
+			graphicsPipelineCreateInfo.layout = pipelineLayout;
+
+			graphicsPipelineCreateInfo.renderPass = renderPass;
+			graphicsPipelineCreateInfo.subpass = 0;
+
+			graphicsPipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+			graphicsPipelineCreateInfo.basePipelineIndex = -1;
+
+			VkPipeline pipeline;
+			if (vkCreateGraphicsPipelines(logicalDevice, pipelineCache.getHandle(), 1, &graphicsPipelineCreateInfo, nullptr, &pipeline) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to create graphics pipeline");
+			}
+
+			return pipeline;
+		}
+
+		void startShaderReloader() {
+			std::vector<ShaderSource> sources = {{"shaders/shader.vert", "shaders/vert.spv"}, {"shaders/shader.frag", "shaders/frag.spv"}};
+
+			// runs on the reloader's thread, everything it touches is either immutable after startup or externally synchronised by Vulkan
+			shaderReloader.start(logicalDevice, sources, [this](const std::vector<ShaderCode>& spirv) {
+				// both modules are created inside the try, so a bad fragment stage doesn't leak the vertex module; destroying VK_NULL_HANDLE is a no-op
+				VkShaderModule vertexModule = VK_NULL_HANDLE;
+				VkShaderModule fragmentModule = VK_NULL_HANDLE;
+
+				VkPipeline pipeline = VK_NULL_HANDLE;
+				try {
+					vertexModule = createShaderModule(spirv[0]);
+					fragmentModule = createShaderModule(spirv[1]);
+					pipeline = buildGraphicsPipeline(vertexModule, fragmentModule, PipelineVariantDesc());
+				}
+				catch (...) {
+					vkDestroyShaderModule(logicalDevice, fragmentModule, nullptr);
+					vkDestroyShaderModule(logicalDevice, vertexModule, nullptr);
+					throw;
+				}
+
+				vkDestroyShaderModule(logicalDevice, fragmentModule, nullptr);
+				vkDestroyShaderModule(logicalDevice, vertexModule, nullptr);
+
+				return pipeline;
+			});
+		}
+
+		// called between frames, so no command buffer is being recorded with the pipeline being replaced
+		void swapReloadedPipeline() {
+			VkPipeline pipeline = shaderReloader.takePipeline();
+			if (pipeline == VK_NULL_HANDLE) {
+				return;
+			}
+
+			retiredPipelines.push_back({graphicsPipeline, frameNumber});
+			graphicsPipeline = pipeline;
+		}
+
+		void destroyRetiredPipelines() {
+			// a replaced pipeline is unused once the last frame recorded with it has finished
+			auto retired = retiredPipelines.begin();
+			while (retired != retiredPipelines.end()) {
+				if (!frameTimeline.isFrameComplete(retired->retiredAtFrame)) {
+					++retired;
+					continue;
+				}
+
+				vkDestroyPipeline(logicalDevice, retired->pipeline, nullptr);
+				retired = retiredPipelines.erase(retired);
+			}
+		}
+
+		void createCullingPipeline() {
+			cullingDescriptorSetLayout = GpuCuller::createDescriptorSetLayout(logicalDevice);
+			createComputePipeline(cullingShaderCode, cullingDescriptorSetLayout, sizeof(CullPushConstants), cullingPipelineLayout, cullingPipeline);
+		}
+
+		void createParticlePipeline() {
+			particleDescriptorSetLayout = ParticleSystem::createDescriptorSetLayout(logicalDevice);
+			createComputePipeline(particleShaderCode, particleDescriptorSetLayout, sizeof(ParticlePushConstants), particlePipelineLayout, particlePipeline);
+		}
+
+		// compute pipelines here take one descriptor set and a block of push constants
+		void createComputePipeline(ShaderCode shaderCode, VkDescriptorSetLayout setLayout, uint32_t pushConstantSize, VkPipelineLayout& layout, VkPipeline& pipeline) {
+			VkPushConstantRange pushConstantRange{};
+			pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+			pushConstantRange.offset = 0;
+			pushConstantRange.size = pushConstantSize;
+
+			VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+			pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+			pipelineLayoutCreateInfo.setLayoutCount = 1;
+			pipelineLayoutCreateInfo.pSetLayouts = &setLayout;
+			pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+			pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+
+			if (vkCreatePipelineLayout(logicalDevice, &pipelineLayoutCreateInfo, nullptr, &layout) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to create compute pipeline layout");
+			}
+
+			VkShaderModule computeShaderModule = createShaderModule(shaderCode);
+
+			VkComputePipelineCreateInfo computePipelineCreateInfo{};
+			computePipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+			computePipelineCreateInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+			computePipelineCreateInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+			computePipelineCreateInfo.stage.module = computeShaderModule;
+			computePipelineCreateInfo.stage.pName = "main";
+			computePipelineCreateInfo.layout = layout;
+
+			auto compileStart = std::chrono::steady_clock::now();
+
+			if (vkCreateComputePipelines(logicalDevice, pipelineCache.getHandle(), 1, &computePipelineCreateInfo, nullptr, &pipeline) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to create compute pipeline");
+			}
+
+			pipelineCache.recordCompileTime(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - compileStart).count());
+
+			vkDestroyShaderModule(logicalDevice, computeShaderModule, nullptr);
+		}
+
+		VkShaderModule createShaderModule(ShaderCode code) {
+			// populate shader module creation struct, the code is read in place
+			VkShaderModuleCreateInfo createInfo{};
+			createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+			createInfo.codeSize = code.size;
+			createInfo.pCode = code.words;
+
+			VkShaderModule shaderModule;
+
+			if (vkCreateShaderModule(logicalDevice, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to create shader module");
+			}
+
+			return shaderModule;
+		}
+
+		void createRenderPass() {
+			VkAttachmentDescription colourAttachment{};
+			colourAttachment.format = swapchainImageFormat;
+			colourAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+
+			colourAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR; // clear framebuffer to black before drawing new frame
+			colourAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+
+			colourAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			colourAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+			colourAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			colourAttachment.finalLayout = getFinalImageLayout();
+
+			VkAttachmentReference colourAttachmentRef{};
+			colourAttachmentRef.attachment = 0;
+			colourAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+			VkSubpassDescription subpass{};
+			subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+			subpass.colorAttachmentCount = 1;
+			subpass.pColorAttachments = &colourAttachmentRef;
+
+			VkSubpassDependency dependency{};
+			dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+			dependency.dstSubpass = 0;
+			dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+			dependency.srcAccessMask = 0;
+			dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+			dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+			VkRenderPassCreateInfo renderPassCreateInfo{};
+			renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+			renderPassCreateInfo.attachmentCount = 1;
+			renderPassCreateInfo.pAttachments = &colourAttachment;
+			renderPassCreateInfo.subpassCount = 1;
+			renderPassCreateInfo.pSubpasses = &subpass;
+			renderPassCreateInfo.dependencyCount = 1;
+			renderPassCreateInfo.pDependencies = &dependency;
+
+			if (vkCreateRenderPass(logicalDevice, &renderPassCreateInfo, nullptr, &renderPass) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to create render pass");
+			}
+		}
+
+		void createFramebuffers() {
+			swapchainFramebuffers.resize(swapchainImageViews.size());
+
+			// create a framebuffer for each image view
+			for (size_t i = 0; i < swapchainImageViews.size(); i++) {
+				VkImageView attachments[] = {swapchainImageViews[i]};
+
+				VkFramebufferCreateInfo framebufferCreateInfo{};
+				framebufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+				framebufferCreateInfo.renderPass = renderPass;
+				framebufferCreateInfo.attachmentCount = 1;
+				framebufferCreateInfo.pAttachments = attachments;
+				framebufferCreateInfo.width = swapchainExtent.width;
+				framebufferCreateInfo.height = swapchainExtent.height;
+				framebufferCreateInfo.layers = 1;
+
+				if (vkCreateFramebuffer(logicalDevice, &framebufferCreateInfo, nullptr, &swapchainFramebuffers[i]) != VK_SUCCESS) {
+					throw std::runtime_error("ERROR: Failed to create framebuffer");
+				}
+			}
+		}
+
+		VkCommandPool createTransientCommandPool(uint32_t queueFamilyIndex) {
+			VkCommandPoolCreateInfo commandPoolCreateInfo{};
+			commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			commandPoolCreateInfo.queueFamilyIndex = queueFamilyIndex;
+			commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT; // command buffers are re-recorded every frame and freed by resetting the whole pool
+
+			VkCommandPool pool;
+			if (vkCreateCommandPool(logicalDevice, &commandPoolCreateInfo, nullptr, &pool) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to create command pool");
+			}
+
+			return pool;
+		}
+
+		void createCommandPools() {
+			QueueFamilyIndices queueFamilyIndices = findQueueFamilies(physicalDevice);
+
+			// single threaded recording writes straight into the primary command buffer, so only needs the primary pool
+			uint32_t threadPoolCount = config.recordThreads > 1 ? config.recordThreads : 0;
+
+			frameCommands.resize(config.framesInFlight);
+			for (auto& frame : frameCommands) {
+				frame.primaryPool = createTransientCommandPool(queueFamilyIndices.graphicsFamily.value());
+
+				for (uint32_t i = 0; i < threadPoolCount; i++) {
+					frame.threadPools.push_back(createTransientCommandPool(queueFamilyIndices.graphicsFamily.value()));
+				}
+			}
+		}
+
+		void createProfiler() {
+			QueueFamilyIndices queueFamilyIndices = findQueueFamilies(physicalDevice);
+
+			// one query slot per frame in flight, matching the command buffers
+			profiler.create(physicalDevice, logicalDevice, queueFamilyIndices.graphicsFamily.value(), config.framesInFlight, pipelineStatisticsEnabled);
+		}
+
+		void createCommandBuffers() {
+			// one primary command buffer per frame in flight, plus a secondary per recording thread, re-recorded each frame so they always target the current swapchain
+			for (auto& frame : frameCommands) {
+				VkCommandBufferAllocateInfo allocateInfo{};
+				allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+				allocateInfo.commandPool = frame.primaryPool;
+				allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+				allocateInfo.commandBufferCount = 1;
+
+				if (vkAllocateCommandBuffers(logicalDevice, &allocateInfo, &frame.primaryCommandBuffer) != VK_SUCCESS) {
+					throw std::runtime_error("ERROR: Failed to allocate command buffers");
+				}
+
+				frame.secondaryCommandBuffers.resize(frame.threadPools.size());
+				for (size_t i = 0; i < frame.threadPools.size(); i++) {
+					allocateInfo.commandPool = frame.threadPools[i];
+					allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+
+					if (vkAllocateCommandBuffers(logicalDevice, &allocateInfo, &frame.secondaryCommandBuffers[i]) != VK_SUCCESS) {
+						throw std::runtime_error("ERROR: Failed to allocate secondary command buffers");
+					}
+				}
+			}
+
+			recordingWorkers.start(config.recordThreads);
+		}
+
+		void resetFrameCommands(FrameCommands& frame) {
+			// resetting a pool recycles all of its command buffers at once, which is cheaper than resetting them one by one
+			vkResetCommandPool(logicalDevice, frame.primaryPool, 0);
+			for (auto pool : frame.threadPools) {
+				vkResetCommandPool(logicalDevice, pool, 0);
+			}
+		}
+
+		void createGeometryBuffers() {
+			// static geometry is copied once through the staging buffer into device local memory
+			QueueFamilyIndices queueFamilyIndices = findQueueFamilies(physicalDevice);
+			uploader.create(allocator, logicalDevice, queueFamilyIndices.graphicsFamily.value(), graphicsQueue);
+
+			if (config.meshPath.empty()) {
+				mesh = makeTriangleMesh();
+				uploadGeometry(mesh.vertices.data(), mesh.vertices.size(), mesh.indices.data(), mesh.indices.size());
+				meshRadius = meshBoundingRadius(mesh);
+			}
+			else {
+				loadMeshFile();
+			}
+
+			std::vector<InstanceData> instances = makeInstanceGrid(config.instanceCount);
+			// also a storage buffer, as the culling shader reads the instance bounds
+			instanceBuffer = uploader.createDeviceLocalBuffer(instances.data(), sizeof(InstanceData) * instances.size(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+		}
+
+		void loadMeshFile() {
+			auto loadStart = std::chrono::steady_clock::now();
+
+			std::string extension = config.meshPath.substr(config.meshPath.find_last_of('.') + 1);
+			if (extension != "vtmesh") {
+				importMeshFile();
+				meshLoadStats.loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+				return;
+			}
+
+			MappedMeshFile file;
+			file.open(config.meshPath);
+			const MeshFileHeader& header = file.getHeader();
+
+			uploadGeometry(file.getVertices(), header.vertexCount, file.getIndices(), header.indexCount);
+			meshRadius = header.boundingRadius;
+
+			meshLoadStats.vertexCount = header.vertexCount;
+			meshLoadStats.indexCount = header.indexCount;
+			meshLoadStats.bytes = file.getVertexBytes() + file.getIndexBytes();
+			meshLoadStats.loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+		}
+
+		void importMeshFile() {
+			WorkerPool importPool;
+			importPool.start(std::max(1u, std::thread::hardware_concurrency()));
+
+			Mesh imported = importMesh(config.meshPath, importPool, meshLoadStats.import);
+			meshLoadStats.optimization = optimizeMesh(imported);
+			meshLoadStats.imported = true;
+
+			uploadGeometry(imported.vertices.data(), imported.vertices.size(), imported.indices.data(), imported.indices.size());
+			meshRadius = meshBoundingRadius(imported);
+
+			meshLoadStats.vertexCount = imported.vertices.size();
+			meshLoadStats.indexCount = imported.indices.size();
+			meshLoadStats.bytes = sizeof(Vertex) * imported.vertices.size() + sizeof(uint32_t) * imported.indices.size();
+		}
+
+		// fills the vertex and index buffers, converting the geometry first unless it is drawn as full float vertices
+		void uploadGeometry(const Vertex* vertices, size_t vertexCount, const uint32_t* indices, size_t indexCount) {
+			// mesh files are not trusted, and packing to 16 bit indices would silently wrap any index out of range
+			if (!indicesInRange(indices, indexCount, vertexCount)) {
+				throw std::runtime_error("ERROR: Mesh has indices beyond its " + std::to_string(vertexCount) + " vertices");
+			}
+
+			geometryStats.format = config.vertexFormat;
+			geometryStats.vertexCount = vertexCount;
+			geometryStats.indexCount = indexCount;
+			geometryStats.bytesPerVertex = getVertexStride(config.vertexFormat);
+			meshIndexCount = static_cast<uint32_t>(indexCount);
+
+			if (config.vertexFormat == VertexFormat::Float) {
+				// the source is already laid out as the buffers hold it, so a mapped mesh file is copied from the mapping into staging memory with no copy on the heap in between
+				vertexBuffer = uploader.createDeviceLocalBuffer(vertices, sizeof(Vertex) * vertexCount, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+				indexBuffer = uploader.createDeviceLocalBuffer(indices, sizeof(uint32_t) * indexCount, VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+				geometryStats.bytesPerIndex = sizeof(uint32_t);
+				return;
+			}
+
+			PackedGeometry packed = packGeometry(vertices, vertexCount, indices, indexCount, config.vertexFormat);
+			vertexBuffer = uploader.createDeviceLocalBuffer(packed.vertices.data(), packed.vertices.size(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+			indexBuffer = uploader.createDeviceLocalBuffer(packed.indices.data(), packed.indices.size(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+			meshIndexType = packed.indexType;
+			meshDequantisation = packed.dequantisation;
+			geometryStats.bytesPerIndex = packed.indexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+		}
+
+		void createCuller() {
+			if (!multiDrawIndirectEnabled || !drawIndirectFirstInstanceEnabled) {
+				throw std::runtime_error("ERROR: GPU culling needs the multiDrawIndirect and drawIndirectFirstInstance features");
+			}
+
+			culler.create(allocator, logicalDevice, config.framesInFlight, cullingDescriptorSetLayout, instanceBuffer.buffer, config.instanceCount, meshIndexCount, meshRadius, cmdDrawIndexedIndirectCount);
+		}
+
+		// pans a zoomed in view in a circle over the instance grid, the whole grid is shown when the zoom is 1
+		ViewTransform currentViewTransform() const {
+			float angle = 0.005f * static_cast<float>(frameNumber);
+			float panRadius = 1.0f - 1.0f / config.viewZoom;
+
+			ViewTransform view;
+			view.offset[0] = panRadius * std::cos(angle);
+			view.offset[1] = panRadius * std::sin(angle);
+			view.scale[0] = config.viewZoom;
+			view.scale[1] = config.viewZoom;
+
+			return view;
+		}
+
+		void createDescriptorLayouts() {
+			drawDescriptorSetLayout = DrawDescriptorSets::createDescriptorSetLayout(logicalDevice);
+
+			// the table is one binding, so it must fit the device's per stage and per set storage buffer limits
+			VkPhysicalDeviceProperties deviceProperties;
+			vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+			uint32_t capacity = std::min({DESCRIPTOR_TABLE_CAPACITY, deviceProperties.limits.maxPerStageDescriptorStorageBuffers, deviceProperties.limits.maxDescriptorSetStorageBuffers});
+
+			descriptorTable.create(logicalDevice, capacity, VK_SHADER_STAGE_VERTEX_BIT);
+		}
+
+		// the most draws a frame can submit, each needing its own set with --per-draw-descriptor-sets
+		uint32_t maxDrawsPerFrame() const {
+			if (config.individualDraws) {
+				return drawnInstanceCount();
+			}
+
+			return config.pipelineVariants * std::max<uint32_t>(1, config.recordThreads);
+		}
+
+		void createDrawDescriptors() {
+			VkPhysicalDeviceProperties deviceProperties;
+			vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+			uniformAlignment = deviceProperties.limits.minUniformBufferOffsetAlignment;
+
+			uniformRing.create(physicalDevice, allocator, logicalDevice, UNIFORM_RING_FRAME_SIZE, config.framesInFlight, frameTimeline, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT);
+			drawDescriptors.create(logicalDevice, drawDescriptorSetLayout, uniformRing.getBuffer(), config.framesInFlight, config.perDrawDescriptorSets ? maxDrawsPerFrame() : 0);
+
+			// every material is one storage buffer range registered in the table once, draws only ever refer to them by index
+			uint32_t materialCount = sizeof(MATERIAL_COLOURS) / sizeof(MATERIAL_COLOURS[0]);
+			VkDeviceSize alignment = deviceProperties.limits.minStorageBufferOffsetAlignment;
+			VkDeviceSize stride = (sizeof(MATERIAL_COLOURS[0]) + alignment - 1) / alignment * alignment;
+
+			materialBuffer = createBuffer(allocator, logicalDevice, stride * materialCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+			for (uint32_t i = 0; i < materialCount; i++) {
+				std::memcpy(static_cast<char*>(materialBuffer.allocation.mapped) + stride * i, MATERIAL_COLOURS[i], sizeof(MATERIAL_COLOURS[i]));
+				materialIndices.push_back(descriptorTable.registerBuffer(materialBuffer.buffer, stride * i, sizeof(MATERIAL_COLOURS[i])));
+			}
+		}
+
+		void createUploadScheduler() {
+			QueueFamilyIndices queueFamilyIndices = findQueueFamilies(physicalDevice);
+
+			// uploaded data is read as vertices or storage buffers, so that is where frames wait for it
+			uploadScheduler.create(allocator, logicalDevice, frameTimeline, uploadQueue, uploadQueueFamily, queueFamilyIndices.graphicsFamily.value(), VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_SHADER_READ_BIT);
+
+			VkDeviceSize uploadSize = static_cast<VkDeviceSize>(config.uploadMiB) * 1024 * 1024;
+			uploadTarget = createBuffer(allocator, logicalDevice, uploadSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+			uploadSource.resize(static_cast<size_t>(uploadSize));
+			for (size_t i = 0; i < uploadSource.size(); i++) {
+				uploadSource[i] = static_cast<uint8_t>((i * 2654435761u) >> 24);
+			}
+		}
+
+		// offers the whole source to the scheduler in batch sized pieces, those refused while every batch is in flight or the frame which acquired the last copy of the range is still running are dropped for this frame
+		void queueFrameUploads() {
+			VkDeviceSize uploadSize = uploadSource.size();
+			for (VkDeviceSize offset = 0; offset < uploadSize; offset += UPLOAD_BATCH_SIZE) {
+				VkDeviceSize size = std::min(UPLOAD_BATCH_SIZE, uploadSize - offset);
+				uploadScheduler.upload(uploadTarget.buffer, offset, uploadSource.data() + offset, size);
+			}
+			uploadScheduler.submit();
+		}
+
+		void createStreamingRing() {
+			// sized once up front so it never reallocates, with room for the streamed mesh if it outgrows the default
+			VkDeviceSize frameSize = std::max<VkDeviceSize>(STREAMING_RING_FRAME_SIZE, sizeof(Vertex) * mesh.vertices.size());
+			streamingRing.create(physicalDevice, allocator, logicalDevice, frameSize, config.framesInFlight, frameTimeline, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+		}
+
+		void recordCommandBuffer(FrameCommands& frame, uint32_t imageIndex) {
+			VkCommandBuffer commandBuffer = frame.primaryCommandBuffer;
+
+			VkCommandBufferBeginInfo beginInfo{};
+			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+			beginInfo.pInheritanceInfo = nullptr;
+
+			if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to begin recording command buffer");
+			}
+
+			profiler.cmdBegin(commandBuffer, static_cast<uint32_t>(currentFrame));
+
+			// ranges whose uploads have finished are handed to the graphics queue before anything in the frame may read them
+			uploadWaitValue = 0;
+			if (config.uploadMiB > 0) {
+				uploadWaitValue = uploadScheduler.cmdAcquire(commandBuffer, frameNumber + 1);
+			}
+
+			if (config.gpuCulling) {
+				culler.cmdCull(commandBuffer, static_cast<uint32_t>(currentFrame), cullingPipeline, cullingPipelineLayout, currentViewTransform());
+			}
+
+			if (config.scene == Scene::Particles) {
+				// the draws below read the simulation's output, the barriers between the two are recorded by cmdSimulate
+				profiler.cmdBeginCompute(commandBuffer, static_cast<uint32_t>(currentFrame));
+				particles.cmdSimulate(commandBuffer, particlePipeline, particlePipelineLayout);
+				profiler.cmdEndCompute(commandBuffer, static_cast<uint32_t>(currentFrame));
+			}
+
+			VkRenderPassBeginInfo renderPassInfo{};
+			renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+			renderPassInfo.renderPass = renderPass;
+			renderPassInfo.framebuffer = swapchainFramebuffers[imageIndex];
+
+			renderPassInfo.renderArea.offset = {0, 0};
+			renderPassInfo.renderArea.extent = swapchainExtent;
+
+			VkClearValue clearColour = {0.3f, 0.5f, 0.8f, 1.0f};
+			renderPassInfo.clearValueCount = 1;
+			renderPassInfo.pClearValues = &clearColour;
+
+			RenderGeometry geometry = prepareGeometry();
+
+			// the culled draws are a single indirect command, so there is nothing to sort or split across threads
+			if (config.gpuCulling) {
+				vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+				recordCulledDraws(commandBuffer, geometry);
+			}
+			else if (frame.secondaryCommandBuffers.empty()) {
+				fillRenderQueue(geometry, 1);
+				vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+				renderQueueBinds = recordDraws(commandBuffer, 0, renderQueue.size());
+			}
+			else {
+				uint32_t threadCount = static_cast<uint32_t>(frame.secondaryCommandBuffers.size());
+				fillRenderQueue(geometry, threadCount);
+				vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+				// each thread replays an equal share of the sorted queue into its own secondary command buffer
+				size_t drawCount = renderQueue.size();
+				std::vector<RenderBindCounts> threadBinds(threadCount);
+				recordingWorkers.run([&](uint32_t thread) {
+					size_t begin = drawCount * thread / threadCount;
+					size_t end = drawCount * (thread + 1) / threadCount;
+					threadBinds[thread] = recordSecondaryCommandBuffer(frame.secondaryCommandBuffers[thread], imageIndex, begin, end);
+				});
+
+				renderQueueBinds = RenderBindCounts();
+				for (const auto& binds : threadBinds) {
+					renderQueueBinds.add(binds);
+				}
+
+				vkCmdExecuteCommands(commandBuffer, threadCount, frame.secondaryCommandBuffers.data());
+			}
+
+			vkCmdEndRenderPass(commandBuffer);
+
+			// the capture copy is recorded with the frame and read back once the frame has finished, so it never stalls the loop
+			if (config.captureEvery > 0 && frameNumber % config.captureEvery == 0) {
+				frameCapture.cmdCapture(commandBuffer, swapchainImages[imageIndex], getFinalImageLayout(), swapchainExtent, frameNumber + 1);
+			}
+
+			if (config.gpuCulling) {
+				culler.cmdReadback(commandBuffer, static_cast<uint32_t>(currentFrame));
+			}
+
+			profiler.cmdEnd(commandBuffer, static_cast<uint32_t>(currentFrame));
+
+			if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to record command buffer");
+			}
+		}
+
+		uint32_t drawnInstanceCount() const {
+			return config.scene == Scene::Particles ? config.particleCount : config.instanceCount;
+		}
+
+		RenderGeometry prepareGeometry() {
+			RenderGeometry bindings = {{vertexBuffer.buffer, instanceBuffer.buffer}, {0, 0}, indexBuffer.buffer, meshIndexType};
+
+			if (config.scene == Scene::Particles) {
+				// each particle is drawn as an instance of the mesh straight from the simulation's output
+				bindings.buffers[1] = particles.getInstanceBuffer();
+			}
+
+			if (config.streamedGeometry) {
+				// dynamic geometry is written straight into this frame's region of the persistently mapped ring
+				StreamingAllocation vertices = streamingRing.allocate(sizeof(Vertex) * mesh.vertices.size(), sizeof(float));
+				writeRotatedVertices(mesh, 0.01f * static_cast<float>(frameNumber), static_cast<Vertex*>(vertices.data));
+
+				bindings.buffers[0] = vertices.buffer;
+				bindings.offsets[0] = vertices.offset;
+			}
+
+			return bindings;
+		}
+
+		// submits the frame's draws, with the instances split into shareCount instanced draws unless each is drawn on its own
+		void fillRenderQueue(const RenderGeometry& geometry, uint32_t shareCount) {
+			renderQueue.reset();
+
+			// written once at startup, every group binds it at the offset of its own uniforms
+			uint32_t sharedDescriptorSet = renderQueue.addDescriptorSet(drawDescriptors.getSharedSet(), true);
+			uint32_t geometryIndex = renderQueue.addGeometry(geometry);
+
+			// one group per pipeline variant, each drawn with the default pipeline until its variant is built
+			uint32_t groupCount = std::max<uint32_t>(1, static_cast<uint32_t>(pipelineVariantDescs.size()));
+			uint32_t instanceCount = drawnInstanceCount();
+
+			auto descriptorStart = std::chrono::steady_clock::now();
+			writeDrawUniforms(groupCount);
+			double descriptorMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - descriptorStart).count();
+
+			groupPipelines.clear();
+			for (uint32_t group = 0; group < groupCount; group++) {
+				VkPipeline variant = groupCount > 1 ? pipelineVariants.get(pipelineVariantDescs[group], graphicsPipeline) : graphicsPipeline;
+				groupPipelines.push_back(renderQueue.addPipeline(variant, pipelineLayout));
+			}
+
+			// visits every draw in submission order with its group, instance count and first instance
+			auto forEachDraw = [&](auto&& visit) {
+				if (config.individualDraws) {
+					// groups are interleaved across the instances, so draws submitted one after another use different pipelines and uniforms and only sorting lets them share binds
+					// same output as the instanced draw, firstInstance selects each copy's instance data
+					for (uint32_t instance = 0; instance < instanceCount; instance++) {
+						visit(instance % groupCount, 1, instance);
+					}
+					return;
+				}
+
+				// an instanced draw needs contiguous instances, so each group is a contiguous range split into a draw per share
+				for (uint32_t group = 0; group < groupCount; group++) {
+					uint32_t groupFirst = static_cast<uint32_t>(uint64_t(instanceCount) * group / groupCount);
+					uint32_t groupSize = static_cast<uint32_t>(uint64_t(instanceCount) * (group + 1) / groupCount) - groupFirst;
+					for (uint32_t share = 0; share < shareCount; share++) {
+						uint32_t firstInstance = groupFirst + static_cast<uint32_t>(uint64_t(groupSize) * share / shareCount);
+						uint32_t endInstance = groupFirst + static_cast<uint32_t>(uint64_t(groupSize) * (share + 1) / shareCount);
+						if (firstInstance != endInstance) {
+							visit(group, endInstance - firstInstance, firstInstance);
+						}
+					}
+				}
+			};
+
+			// the baseline allocates and writes a set for every draw up front, each pointing at its group's uniforms directly
+			if (config.perDrawDescriptorSets) {
+				auto allocateStart = std::chrono::steady_clock::now();
+
+				perDrawSets.clear();
+				forEachDraw([&](uint32_t group, uint32_t, uint32_t) {
+					perDrawSets.push_back(renderQueue.addDescriptorSet(drawDescriptors.allocatePerDraw(drawUniformOffsets[group]), true));
+				});
+
+				descriptorMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - allocateStart).count();
+			}
+
+			// grid draws sort nearest the centre of the view first, which moves as the view pans so the order changes every frame
+			ViewTransform view = currentViewTransform();
+			uint32_t gridSide = instanceGridSide(instanceCount);
+			const float maxDistance = 2.0f * std::sqrt(2.0f);
+
+			uint32_t draw = 0;
+			forEachDraw([&](uint32_t group, uint32_t drawInstanceCount, uint32_t firstInstance) {
+				float depth = 0.0f;
+				if (config.scene == Scene::Triangles) {
+					float position[2];
+					instanceGridPosition(firstInstance, gridSide, position);
+					depth = std::hypot(position[0] - view.offset[0], position[1] - view.offset[1]) / maxDistance;
+				}
+
+				// the group stands in for its descriptor set, as per draw sets would overflow the key and all point at the same uniforms
+				uint32_t material = materialIndices[group % materialIndices.size()];
+				uint64_t sortKey = makeSortKey(0, groupPipelines[group], group, material, depth);
+
+				uint32_t descriptorSet = config.perDrawDescriptorSets ? perDrawSets[draw] : sharedDescriptorSet;
+				uint32_t dynamicOffset = config.perDrawDescriptorSets ? 0 : drawUniformOffsets[group];
+				renderQueue.submit(sortKey, {groupPipelines[group], descriptorSet, dynamicOffset, geometryIndex, meshIndexCount, drawInstanceCount, firstInstance});
+				draw++;
+			});
+
+			descriptorUpdateMs.push(descriptorMs);
+			descriptorCounts = drawDescriptors.getFrameCounts();
+
+			renderQueue.sort();
+			renderQueueSortMs.push(renderQueue.getLastSortMs());
+		}
+
+		// one set of uniforms for each group of draws, written into this frame's region of the uniform ring
+		void writeDrawUniforms(uint32_t groupCount) {
+			drawUniformOffsets.clear();
+
+			for (uint32_t group = 0; group < groupCount; group++) {
+				DrawUniforms uniforms{};
+				uniforms.material = materialIndices[group % materialIndices.size()];
+
+				StreamingAllocation allocation = uniformRing.allocate(sizeof(DrawUniforms), uniformAlignment);
+				std::memcpy(allocation.data, &uniforms, sizeof(DrawUniforms));
+				drawUniformOffsets.push_back(static_cast<uint32_t>(allocation.offset));
+			}
+		}
+
+		RenderBindCounts recordSecondaryCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex, size_t begin, size_t end) {
+			// secondary command buffers continue the primary's render pass, so they must know which one and its framebuffer
+			VkCommandBufferInheritanceInfo inheritanceInfo{};
+			inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+			inheritanceInfo.renderPass = renderPass;
+			inheritanceInfo.subpass = 0;
+			inheritanceInfo.framebuffer = swapchainFramebuffers[imageIndex];
+			inheritanceInfo.pipelineStatistics = profiler.getPipelineStatistics();
+
+			VkCommandBufferBeginInfo beginInfo{};
+			beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+			beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+			if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to begin recording secondary command buffer");
+			}
+
+			RenderBindCounts binds = recordDraws(commandBuffer, begin, end);
+
+			if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to record secondary command buffer");
+			}
+
+			return binds;
+		}
+
+		// replays sorted draws [begin, end) of the render queue, state is set from scratch as secondary command buffers inherit none of it
+		RenderBindCounts recordDraws(VkCommandBuffer commandBuffer, size_t begin, size_t end) {
+			if (begin == end) {
+				return RenderBindCounts();
+			}
+
+			// push constants and dynamic state belong to the command buffer rather than the pipeline, so they are set once ahead of the queue's binds
+			cmdSetDrawState(commandBuffer);
+
+			return renderQueue.replay(commandBuffer, begin, end);
+		}
+
+		void recordCulledDraws(VkCommandBuffer commandBuffer, const RenderGeometry& geometry) {
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
+			cmdSetDrawState(commandBuffer);
+
+			// every culled draw is one group with the first material
+			writeDrawUniforms(1);
+			VkDescriptorSet drawSet = drawDescriptors.getSharedSet();
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &drawSet, 1, &drawUniformOffsets[0]);
+
+			vkCmdBindVertexBuffers(commandBuffer, 0, 2, geometry.buffers, geometry.offsets);
+			vkCmdBindIndexBuffer(commandBuffer, geometry.indexBuffer, 0, geometry.indexType);
+
+			culler.cmdDraw(commandBuffer, static_cast<uint32_t>(currentFrame));
+		}
+
+		void cmdSetDrawState(VkCommandBuffer commandBuffer) {
+			VertexPushConstants pushConstants;
+			pushConstants.view = currentViewTransform();
+			pushConstants.dequantisation = meshDequantisation;
+			vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(VertexPushConstants), &pushConstants);
+
+			// the material table is the same for every draw, so it is bound once and left alone by the queue's set 0 binds
+			VkDescriptorSet tableSet = descriptorTable.getSet();
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 1, 1, &tableSet, 0, nullptr);
+
+			// draw entire framebuffer to viewport
+			VkViewport viewport{};
+			viewport.x = 0.0f;
+			viewport.y = 0.0f;
+			viewport.width = (float) swapchainExtent.width;
+			viewport.height = (float) swapchainExtent.height;
+			viewport.minDepth = 0.0f;
+			viewport.maxDepth = 1.0f;
+			vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+			VkRect2D scissor{};
+			scissor.offset = {0, 0};
+			scissor.extent = swapchainExtent;
+			vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+		}
+
+		void createSyncObjects() {
+			// acquire and present only accept binary semaphores, everything else waits on the frame timeline
+			imageAvailableSemaphores.resize(config.framesInFlight);
+			renderFinishedSemaphores.resize(config.framesInFlight);
+
+			VkSemaphoreCreateInfo semaphoreCreateInfo{};
+			semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+			for (size_t i = 0; i < config.framesInFlight; i++) {
+				if (vkCreateSemaphore(logicalDevice, &semaphoreCreateInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS || vkCreateSemaphore(logicalDevice, &semaphoreCreateInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS) {
+					throw std::runtime_error("ERROR: Failed to create synchronisation objects");
+				}
+			}
+
+			frameTimeline.create(logicalDevice);
+		}
+
+		void mainLoop() {
+			uint64_t frameLimit = config.frameCount;
+			if (config.headless && frameLimit == 0) {
+				frameLimit = HEADLESS_DEFAULT_FRAME_COUNT;
+			}
+
+			uint64_t framesRendered = 0;
+			auto startTime = std::chrono::steady_clock::now();
+
+			while (frameLimit == 0 || framesRendered < frameLimit) {
+				auto frameStart = std::chrono::steady_clock::now();
+
+				if (config.lowLatency) {
+					waitForPreviousFrame();
+				}
+
+				if (!config.headless) {
+					if (glfwWindowShouldClose(window)) {
+						break;
+					}
+					glfwPollEvents();
+				}
+				// there is no input when headless, so the probe measures from the point input would have been polled
+				latencyProbe.sampleInput(frameNumber + 1);
+				// an iteration which only recreated the swapchain rendered nothing, so it is neither counted nor timed
+				if (!drawFrame()) {
+					continue;
+				}
+				framesRendered++;
+
+				if (framesRendered == 1) {
+					runStatistics.timeToFirstFrameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - runStartTime).count();
+				}
+
+				profiler.recordCpuFrameTime(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+			}
+			vkDeviceWaitIdle(logicalDevice);
+
+			// frames still waiting to be written are flushed before the run is reported
+			if (config.captureEvery > 0) {
+				frameCapture.finish();
+				captureStats = frameCapture.getStats();
+			}
+
+			// stopped before cleanup, as a pipeline may still be building on the reloader's thread
+			if (config.hotReload) {
+				shaderReloader.stop();
+				shaderReloadSummary = shaderReloader.summarise();
+			}
+			if (config.pipelineVariants > 1) {
+				pipelineVariantSummary = pipelineVariants.summarise();
+				pipelineVariants.stop();
+			}
+
+			double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+			runStatistics.framesRendered = framesRendered;
+			runStatistics.elapsedSeconds = elapsedSeconds;
+			memoryStats = allocator.getStats();
+
+			if (config.printReport) {
+				std::cout << "First frame submitted " << runStatistics.timeToFirstFrameMs << " ms after startup" << std::endl;
+				std::cout << "Rendered " << framesRendered << " frames in " << elapsedSeconds << " s (" << (elapsedSeconds > 0.0 ? framesRendered / elapsedSeconds : 0.0) << " frames/s)" << std::endl;
+
+				const DeviceCandidate& device = selectedDevice;
+				std::cout << "Device: " << device.name << " (" << deviceTypeName(device.type) << ", score " << device.score.total() << ", " << (config.deviceSelector.empty() ? "highest scoring" : "selected by " + config.deviceSelector) << ")" << std::endl;
+
+				std::cout << "Presentation: " << (config.headless ? "offscreen" : presentModeName(activePresentMode)) << ", " << swapchainImages.size() << " images, " << config.framesInFlight << " frames in flight" << (config.lowLatency ? ", low latency" : "") << std::endl;
+
+				if (!config.meshPath.empty()) {
+					const double MiB = 1024.0 * 1024.0;
+					std::cout << "Mesh: " << meshLoadStats.vertexCount << " vertices, " << meshLoadStats.indexCount << " indices (" << meshLoadStats.bytes / MiB << " MiB) from " << config.meshPath << " loaded in " << meshLoadStats.loadMs << " ms (" << meshLoadStats.bytesPerSecond() / MiB << " MiB/s)" << std::endl;
+					if (meshLoadStats.imported) {
+						const MeshImportStats& import = meshLoadStats.import;
+						const MeshOptimizationStats& optimization = meshLoadStats.optimization;
+						std::cout << "\tImported on " << import.threads << " threads: parse " << import.parseMs << " ms, " << import.sourceVertices << " vertices deduplicated in " << import.deduplicateMs << " ms, optimised in " << optimization.optimizeMs << " ms, peak memory " << import.peakMemoryBytes / MiB << " MiB" << std::endl;
+						std::cout << "\tVertex cache (" << VERTEX_CACHE_SIZE << " entries): ACMR " << optimization.before.acmr << " -> " << optimization.after.acmr << ", ATVR " << optimization.before.atvr << " -> " << optimization.after.atvr << std::endl;
+					}
+				}
+				std::cout << "Vertex format: " << vertexFormatName(geometryStats.format) << ", " << geometryStats.bytesPerVertex << " bytes per vertex and " << geometryStats.bytesPerIndex << " per index, " << geometryStats.bytes() << " bytes of geometry (" << geometryStats.fullFloatBytes() << " as full float)" << std::endl;
+				if (config.captureEvery > 0) {
+					printCaptureReport();
+				}
+				if (config.hotReload) {
+					printShaderReloadReport();
+				}
+				if (config.pipelineVariants > 1) {
+					printPipelineVariantReport();
+				}
+				if (config.uploadMiB > 0) {
+					printUploadReport();
+				}
+				printPipelineCacheReport();
+				printMemoryReport();
+				printProfilerSummary();
+
+				PercentileSummary recreateSummary = swapchainRecreateMs.summarise();
+				if (recreateSummary.count > 0) {
+					std::cout << "Swapchain recreation (ms): p50 " << recreateSummary.p50 << ", p95 " << recreateSummary.p95 << ", p99 " << recreateSummary.p99 << " (" << recreateSummary.count << " recreations)" << std::endl;
+				}
+			}
+		}
+
+		void printCaptureReport() {
+			const double MiB = 1024.0 * 1024.0;
+
+			std::cout << "Capture: " << captureStats.framesWritten << " of " << captureStats.framesCaptured << " captured frames written to " << config.captureDirectory << " as " << captureFormatName(config.captureFormat) << ", " << captureStats.bytesWritten / MiB << " MiB at " << captureStats.bytesPerSecond() / MiB << " MiB/s" << std::endl;
+			if (captureStats.framesDropped > 0) {
+				std::cout << "\t" << captureStats.framesDropped << " frames dropped as the writer fell behind" << std::endl;
+			}
+			if (captureStats.framesSkipped > 0) {
+				std::cout << "\t" << captureStats.framesSkipped << " frames skipped as the window was resized after capture started" << std::endl;
+			}
+		}
+
+		void printUploadReport() {
+			const double MiB = 1024.0 * 1024.0;
+			UploadSummary summary = uploadScheduler.summarise();
+
+			std::cout << "Uploads: " << config.uploadMiB << " MiB per frame on " << (summary.dedicatedQueue ? "a transfer queue (family " + std::to_string(summary.queueFamily) + ")" : std::string("the graphics queue")) << ", " << summary.bytes / MiB << " MiB in " << summary.batches << " batches at " << summary.bytesPerSecond() / MiB << " MiB/s" << std::endl;
+			if (summary.refusedBytes > 0) {
+				std::cout << "\t" << summary.refusedBytes / MiB << " MiB dropped as every batch was in flight or its range still in use" << std::endl;
+			}
+			if (summary.batchLatencyMs.count > 0) {
+				printPercentiles("Submit to finish (ms)", summary.batchLatencyMs, "batches");
+			}
+		}
+
+		void printShaderReloadReport() {
+			const ShaderReloadSummary& summary = shaderReloadSummary;
+
+			std::cout << "Shader reloads: " << summary.reloads << " swapped in, " << summary.failures << " failed" << std::endl;
+			if (summary.reloadMs.count > 0) {
+				printPercentiles("Compile (ms)", summary.compileMs, "reloads");
+				printPercentiles("Pipeline build (ms)", summary.buildMs, "reloads");
+				printPercentiles("Change to swap (ms)", summary.reloadMs, "reloads");
+			}
+		}
+
+		void printPipelineVariantReport() {
+			const PipelineVariantSummary& summary = pipelineVariantSummary;
+
+			std::cout << "Pipeline variants: " << summary.variants << " of " << pipelineVariantDescs.size() << " built on " << PIPELINE_VARIANT_THREADS << " threads, " << summary.failures << " failed, " << summary.queueDepth << " still queued (at most " << summary.maxQueueDepth << "), hit rate " << summary.hitRate() * 100.0 << "% of " << summary.requests << " requests" << std::endl;
+			if (summary.compileMs.count > 0) {
+				printPercentiles("Request to ready (ms)", summary.compileMs, "variants");
+			}
+		}
+
+		void printMemoryReport() {
+			const double MiB = 1024.0 * 1024.0;
+
+			std::cout << "Device memory: " << memoryStats.bytesUsed / MiB << " MiB used of " << memoryStats.bytesReserved / MiB << " MiB reserved in " << memoryStats.blockCount << " blocks (" << memoryStats.allocationCount << " allocations), fragmentation " << memoryStats.fragmentation << std::endl;
+
+			for (size_t i = 0; i < memoryStats.heaps.size(); i++) {
+				const GpuHeapBudget& heap = memoryStats.heaps[i];
+				std::cout << "\tHeap " << i << ": " << heap.usage / MiB << " of " << heap.budget / MiB << " MiB budget" << (memoryStats.budgetFromExtension ? "" : " (estimated)") << (heap.usage > heap.budget * GPU_ALLOCATOR_BUDGET_WARNING ? ", close to budget" : "") << std::endl;
+			}
+		}
+
+		void printPipelineCacheReport() {
+			const PipelineCacheStats& stats = pipelineCache.getStats();
+
+			if (!stats.enabled) {
+				std::cout << "Pipeline cache: disabled, pipelines compiled in " << stats.compileMs << " ms" << std::endl;
+			}
+			else if (stats.hit) {
+				std::cout << "Pipeline cache: hit (" << stats.loadedBytes << " bytes), pipelines compiled in " << stats.compileMs << " ms, saving " << stats.savedMs() << " ms over " << stats.coldCompileMs << " ms uncached" << std::endl;
+			}
+			else {
+				std::cout << "Pipeline cache: miss (" << stats.missReason << "), pipelines compiled in " << stats.compileMs << " ms" << std::endl;
+			}
+		}
+
+		// one indented line of a report, samples names what each sample was taken from
+		static void printPercentiles(const char* name, const PercentileSummary& percentiles, const char* samples = "frames") {
+			std::cout << "\t" << name << ": p50 " << percentiles.p50 << ", p95 " << percentiles.p95 << ", p99 " << percentiles.p99 << " (" << percentiles.count << " " << samples << ")" << std::endl;
+		}
+
+		void printProfilerSummary() {
+			GpuProfilerSummary summary = profiler.summarise();
+
+			std::cout << "Frame statistics:" << std::endl;
+			printPercentiles("CPU frame time (ms)", summary.cpuFrameTimeMs);
+			printPercentiles("CPU frame wait (ms)", summary.cpuWaitMs);
+			printPercentiles("CPU recording (ms)", summary.cpuRecordMs);
+			if (profiler.hasTimestamps()) {
+				printPercentiles("GPU frame time (ms)", summary.gpuTimeMs);
+			}
+			if (profiler.hasPipelineStatistics()) {
+				printPercentiles("Vertex invocations", summary.vertexInvocations);
+				if (profiler.hasTimestamps()) {
+					std::cout << "\tVertices per GPU second: " << getVertexThroughput() << " (" << getVertexThroughput() * geometryStats.bytesPerVertex / (1024.0 * 1024.0 * 1024.0) << " GiB/s of " << vertexFormatName(geometryStats.format) << " vertices)" << std::endl;
+				}
+				printPercentiles("Fragment invocations", summary.fragmentInvocations);
+				printPercentiles("Clipping primitives", summary.clippingPrimitives);
+			}
+			if (renderQueueBinds.draws > 0) {
+				printPercentiles("Render queue sort (ms)", renderQueueSortMs.summarise());
+				std::cout << "\tRender queue binds per frame: " << renderQueueBinds.pipelineBinds << " pipeline, " << renderQueueBinds.descriptorSetBinds << " descriptor set, " << renderQueueBinds.geometryBinds << " geometry for " << renderQueueBinds.draws << " draws, " << renderQueueBinds.savedBinds() << " binds skipped" << std::endl;
+				printPercentiles("Descriptor and uniform updates (ms)", descriptorUpdateMs.summarise());
+				std::cout << "\tDescriptors per frame (" << (config.perDrawDescriptorSets ? "a set per draw" : "shared set, dynamic offsets") << "): " << descriptorCounts.setsAllocated << " sets allocated, " << descriptorCounts.descriptorWrites << " written, " << descriptorTable.getRegisteredCount() << " of " << descriptorTable.getCapacity() << " bindless table slots registered" << std::endl;
+			}
+			if (config.gpuCulling) {
+				GpuCullingSummary cullingSummary = culler.summarise();
+				printPercentiles("Instances drawn", cullingSummary.drawnInstances);
+				printPercentiles("Instances culled", cullingSummary.culledInstances);
+			}
+			if (config.scene == Scene::Particles && profiler.hasTimestamps()) {
+				printPercentiles("GPU simulation time (ms)", summary.gpuComputeMs);
+				std::cout << "\tParticles simulated per second: " << getParticleThroughput() << " (" << config.particleCount << " particles)" << std::endl;
+			}
+
+			LatencySummary latency = latencyProbe.summarise();
+			std::cout << "Latency, present completion " << (presentWaitEnabled ? "measured with VK_KHR_present_wait" : "approximated by GPU completion") << ":" << std::endl;
+			printPercentiles("Input to submit (ms)", latency.inputToSubmitMs);
+			printPercentiles("Submit to present (ms)", latency.submitToPresentMs);
+			printPercentiles("Input to present (ms)", latency.inputToPresentMs);
+			if (latency.droppedFrames > 0) {
+				std::cout << "\t" << latency.droppedFrames << " frames not measured as their swapchain was recreated" << std::endl;
+			}
+		}
+
+		// false when nothing was submitted, as the swapchain had to be recreated first
+		bool drawFrame() {
+			uint64_t frame = frameNumber + 1;
+
+			// frame slots, and offscreen images when headless, are reused round robin, so one wait for the frame which last used them covers both
+			// swapchain images need no wait, as the submission waits for the image to be acquired and nothing else is kept per image
+			uint64_t reuseDistance = config.framesInFlight;
+			if (config.headless) {
+				reuseDistance = std::min<uint64_t>(reuseDistance, swapchainImages.size());
+			}
+
+			auto waitStart = std::chrono::steady_clock::now();
+
+			if (frame > reuseDistance) {
+				frameTimeline.waitForFrame(frame - reuseDistance);
+			}
+
+			std::chrono::duration<double, std::milli> cpuWait = std::chrono::steady_clock::now() - waitStart;
+			profiler.recordCpuWait(cpuWait.count());
+
+			// the frame which last used this slot has finished, so its query results are available and older swapchains may now be unused
+			profiler.collect(static_cast<uint32_t>(currentFrame));
+			if (presentWaitEnabled) {
+				pollPresentCompletion();
+			}
+			else {
+				// without present wait, a frame counts as presented once it is seen to have finished
+				latencyProbe.markPresented(frameTimeline.getCompletedFrame());
+			}
+			streamingRing.beginFrame(frame);
+			uniformRing.beginFrame(frame);
+			drawDescriptors.beginFrame(static_cast<uint32_t>(currentFrame));
+			if (config.captureEvery > 0) {
+				frameCapture.collect();
+			}
+			if (config.gpuCulling) {
+				culler.collect(static_cast<uint32_t>(currentFrame));
+			}
+			resetFrameCommands(frameCommands[currentFrame]);
+			destroyRetiredSwapchains();
+			if (config.hotReload) {
+				swapReloadedPipeline();
+				destroyRetiredPipelines();
+			}
+
+			uint32_t imageIndex;
+
+			if (config.headless) {
+				// no presentation engine hands out images, so cycle through the offscreen targets in order
+				imageIndex = nextOffscreenImage;
+				nextOffscreenImage = (nextOffscreenImage + 1) % static_cast<uint32_t>(swapchainImages.size());
+			}
+			else {
+				// retrieve image from swapchain
+				VkResult result = vkAcquireNextImageKHR(logicalDevice, swapchain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+
+				if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+					// nothing was acquired or submitted, so the frame can simply be retried with the new swapchain
+					recreateSwapChain();
+					return false;
+				}
+				else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+					throw std::runtime_error("ERROR: Failed to acquire swapchain image");
+				}
+			}
+
+			if (config.uploadMiB > 0) {
+				queueFrameUploads();
+			}
+
+			auto recordStart = std::chrono::steady_clock::now();
+			recordCommandBuffer(frameCommands[currentFrame], imageIndex);
+			profiler.recordCpuRecordTime(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - recordStart).count());
+
+			VkSubmitInfo submitInfo{};
+			submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+
+			// offscreen targets are not acquired or presented, so there is nothing to wait on or signal when headless
+			// values given for binary semaphores are ignored
+			VkSemaphore waitSemaphores[2];
+			VkPipelineStageFlags waitStages[2];
+			uint64_t waitValues[2];
+			uint32_t waitCount = 0;
+			if (!config.headless) {
+				waitSemaphores[waitCount] = imageAvailableSemaphores[currentFrame];
+				waitStages[waitCount] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+				waitValues[waitCount] = 0;
+				waitCount++;
+			}
+			// uploads acquired by the frame have already finished, so this wait only orders their writes before the frame's reads
+			if (uploadWaitValue > 0) {
+				waitSemaphores[waitCount] = uploadScheduler.getSemaphore();
+				waitStages[waitCount] = uploadScheduler.getWaitStages();
+				waitValues[waitCount] = uploadWaitValue;
+				waitCount++;
+			}
+			submitInfo.waitSemaphoreCount = waitCount;
+			submitInfo.pWaitSemaphores = waitSemaphores;
+			submitInfo.pWaitDstStageMask = waitStages;
+
+			submitInfo.commandBufferCount = 1;
+			submitInfo.pCommandBuffers = &frameCommands[currentFrame].primaryCommandBuffer;
+
+			// the frame's number is signalled on the timeline when it finishes, the binary semaphore is for presentation
+			VkSemaphore renderFinished = renderFinishedSemaphores[currentFrame];
+			VkSemaphore signalSemaphores[] = {frameTimeline.getSemaphore(), renderFinished};
+			submitInfo.signalSemaphoreCount = config.headless ? 1 : 2;
+			submitInfo.pSignalSemaphores = signalSemaphores;
+
+			uint64_t signalValues[] = {frame, 0};
+			VkTimelineSemaphoreSubmitInfo timelineSubmitInfo{};
+			timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+			timelineSubmitInfo.waitSemaphoreValueCount = submitInfo.waitSemaphoreCount;
+			timelineSubmitInfo.pWaitSemaphoreValues = waitValues;
+			timelineSubmitInfo.signalSemaphoreValueCount = submitInfo.signalSemaphoreCount;
+			timelineSubmitInfo.pSignalSemaphoreValues = signalValues;
+			submitInfo.pNext = &timelineSubmitInfo;
+
+			if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to submit draw coimmand buffer");
+			}
+			latencyProbe.markSubmitted(frame);
+
+			profiler.markSubmitted(static_cast<uint32_t>(currentFrame));
+			if (config.gpuCulling) {
+				culler.markSubmitted(static_cast<uint32_t>(currentFrame));
+			}
+			frameNumber++;
+
+			currentFrame = (currentFrame + 1) % config.framesInFlight;
+
+			if (!config.headless) {
+				presentFrame(imageIndex, renderFinished);
+			}
+
+			return true;
+		}
+
+		void presentFrame(uint32_t imageIndex, VkSemaphore renderFinished) {
+			VkPresentInfoKHR presentInfo{};
+			presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+			presentInfo.waitSemaphoreCount = 1;
+			presentInfo.pWaitSemaphores = &renderFinished;
+
+			VkSwapchainKHR swapchains[] = {swapchain};
+			presentInfo.swapchainCount = 1;
+			presentInfo.pSwapchains = swapchains;
+			presentInfo.pImageIndices = &imageIndex;
+			presentInfo.pResults = nullptr;
+
+			// frameNumber has just been advanced past this frame, so it is the frame's id and increases with every present as required
+			uint64_t presentIdValue = frameNumber;
+			VkPresentIdKHR presentId{};
+			if (presentWaitEnabled) {
+				presentId.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+				presentId.swapchainCount = 1;
+				presentId.pPresentIds = &presentIdValue;
+				presentInfo.pNext = &presentId;
+				lastPresentId = presentIdValue;
+			}
+
+			VkResult result = vkQueuePresentKHR(presentQueue, &presentInfo);
+
+			if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized) {
+				framebufferResized = false;
+				recreateSwapChain();
+			}
+			else if (result != VK_SUCCESS) {
+				throw std::runtime_error("ERROR: Failed to present swapchain image");
+			}
+		}
+
+		// records every frame seen on screen since the last call without blocking
+		void pollPresentCompletion() {
+			while (lastCompletedPresentId < lastPresentId && waitForPresent(logicalDevice, swapchain, lastCompletedPresentId + 1, 0) == VK_SUCCESS) {
+				lastCompletedPresentId++;
+				latencyProbe.markPresented(lastCompletedPresentId);
+			}
+		}
+
+		// low latency mode starts each frame only once the previous one is on screen, so no frames queue up between input and display
+		void waitForPreviousFrame() {
+			if (presentWaitEnabled) {
+				if (lastCompletedPresentId < lastPresentId && waitForPresent(logicalDevice, swapchain, lastPresentId, PRESENT_WAIT_TIMEOUT_NS) == VK_SUCCESS) {
+					lastCompletedPresentId = lastPresentId;
+					latencyProbe.markPresented(lastCompletedPresentId);
+				}
+			}
+			else {
+				// without present wait the closest available is the previous frame's GPU work finishing
+				if (frameNumber > 0) {
+					frameTimeline.waitForFrame(frameNumber);
+					latencyProbe.markPresented(frameNumber);
+				}
+			}
+		}
+
+		// replaces only the swapchain, image views and framebuffers, the pipeline uses dynamic viewport and scissor state and command buffers are recorded every frame
+		void recreateSwapChain() {
+			// a minimised window has a zero sized framebuffer, so wait until it is visible again
+			int width = 0, height = 0;
+			glfwGetFramebufferSize(window, &width, &height);
+			while (width == 0 || height == 0) {
+				if (glfwWindowShouldClose(window)) {
+					return;
+				}
+				glfwWaitEvents();
+				glfwGetFramebufferSize(window, &width, &height);
+			}
+
+			auto recreateStart = std::chrono::steady_clock::now();
+
+			// rather than waiting for the device to go idle, retire the old resources and destroy them once the frames using them have finished
+			retiredSwapchains.push_back({swapchain, swapchainImageViews, swapchainFramebuffers, frameNumber});
+
+			chooseSwapchainProperties();
+			createSwapChain(retiredSwapchains.back().swapchain);
+			createImageViews();
+			createFramebuffers();
+
+			// present ids are per swapchain, so frames presented to the old one can no longer be waited on
+			if (presentWaitEnabled) {
+				lastCompletedPresentId = lastPresentId;
+				latencyProbe.discardPending();
+			}
+
+			swapchainRecreateMs.push(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - recreateStart).count());
+		}
+
+		void destroyRetiredSwapchains() {
+			// a retired swapchain is unused once the last frame rendered to it has finished
+			auto retired = retiredSwapchains.begin();
+			while (retired != retiredSwapchains.end()) {
+				if (!frameTimeline.isFrameComplete(retired->retiredAtFrame)) {
+					++retired;
+					continue;
+				}
+
+				destroySwapchainResources(*retired);
+				retired = retiredSwapchains.erase(retired);
+			}
+		}
+
+		void destroySwapchainResources(const RetiredSwapchain& retired) {
+			for (auto framebuffer : retired.framebuffers) {
+				vkDestroyFramebuffer(logicalDevice, framebuffer, nullptr);
+			}
+
+			for (auto imageView : retired.imageViews) {
+				vkDestroyImageView(logicalDevice, imageView, nullptr);
+			}
+
+			vkDestroySwapchainKHR(logicalDevice, retired.swapchain, nullptr);
+		}
+
+		void cleanup() {
+			for (size_t i = 0; i < config.framesInFlight; i++) {
+				vkDestroySemaphore(logicalDevice, renderFinishedSemaphores[i], nullptr);
+				vkDestroySemaphore(logicalDevice, imageAvailableSemaphores[i], nullptr);
+			}
+			frameTimeline.destroy();
+
+			profiler.destroy();
+			culler.destroy();
+			particles.destroy();
+			frameCapture.destroy();
+
+			streamingRing.destroy();
+			uniformRing.destroy();
+			uploadScheduler.destroy();
+			destroyBuffer(allocator, logicalDevice, uploadTarget);
+			drawDescriptors.destroy();
+			descriptorTable.destroy();
+			destroyBuffer(allocator, logicalDevice, materialBuffer);
+			destroyBuffer(allocator, logicalDevice, instanceBuffer);
+			destroyBuffer(allocator, logicalDevice, indexBuffer);
+			destroyBuffer(allocator, logicalDevice, vertexBuffer);
+			uploader.destroy();
+
+			recordingWorkers.stop();
+
+			for (const auto& frame : frameCommands) {
+				for (auto pool : frame.threadPools) {
+					vkDestroyCommandPool(logicalDevice, pool, nullptr);
+				}
+				vkDestroyCommandPool(logicalDevice, frame.primaryPool, nullptr);
+			}
+
+			// the device is idle by now, so any swapchains still waiting to be retired can go immediately
+			for (const auto& retired : retiredSwapchains) {
+				destroySwapchainResources(retired);
+			}
+
+			for (auto framebuffer : swapchainFramebuffers) {
+				vkDestroyFramebuffer(logicalDevice, framebuffer, nullptr);
+			}
+
+			vkDestroyPipeline(logicalDevice, graphicsPipeline, nullptr);
+			for (const auto& retired : retiredPipelines) {
+				vkDestroyPipeline(logicalDevice, retired.pipeline, nullptr);
+			}
+			// kept for building variants, which were destroyed when the variant manager stopped
+			if (config.pipelineVariants > 1) {
+				vkDestroyShaderModule(logicalDevice, fragmentShaderModule, nullptr);
+				vkDestroyShaderModule(logicalDevice, vertexShaderModule, nullptr);
+			}
+			if (config.gpuCulling) {
+				vkDestroyPipeline(logicalDevice, cullingPipeline, nullptr);
+				vkDestroyPipelineLayout(logicalDevice, cullingPipelineLayout, nullptr);
+				vkDestroyDescriptorSetLayout(logicalDevice, cullingDescriptorSetLayout, nullptr);
+			}
+			if (config.scene == Scene::Particles) {
+				vkDestroyPipeline(logicalDevice, particlePipeline, nullptr);
+				vkDestroyPipelineLayout(logicalDevice, particlePipelineLayout, nullptr);
+				vkDestroyDescriptorSetLayout(logicalDevice, particleDescriptorSetLayout, nullptr);
+			}
+
+			pipelineCache.save();
+			pipelineCache.destroy();
+
+			vkDestroyPipelineLayout(logicalDevice, pipelineLayout, nullptr);
+			vkDestroyDescriptorSetLayout(logicalDevice, drawDescriptorSetLayout, nullptr);
+
+			vkDestroyRenderPass(logicalDevice, renderPass, nullptr);
+
+			for (auto imageView : swapchainImageViews) {
+				vkDestroyImageView(logicalDevice, imageView, nullptr);
+			}
+
+			if (config.headless) {
+				for (size_t i = 0; i < swapchainImages.size(); i++) {
+					vkDestroyImage(logicalDevice, swapchainImages[i], nullptr);
+					allocator.free(offscreenImageMemory[i]);
+				}
+			}
+			else {
+				vkDestroySwapchainKHR(logicalDevice, swapchain, nullptr);
+			}
+
+			allocator.destroy();
+
+			vkDestroyDevice(logicalDevice, nullptr);
+
+			if (enableValidationLayers) {
+				DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
+			}
+
+			if (!config.headless) {
+				vkDestroySurfaceKHR(instance, surface, nullptr);
+			}
+
+			vkDestroyInstance(instance, nullptr);
+
+			if (!config.headless) {
+				glfwDestroyWindow(window);
+
+				glfwTerminate();
+			}
+		}
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <cstdint>
+
+// a fixed set of threads which run one task per thread each time run() is called, used for per-frame work where spawning threads would cost more than the work itself
+// the calling thread runs task 0, so a pool of one thread has no workers and runs everything inline
+class WorkerPool {
+	public:
+		WorkerPool() = default;
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+		~WorkerPool() {
+			stop();
+		}
+
+		void start(uint32_t count) {
+			threadCount = count;
+
+			for (uint32_t i = 1; i < threadCount; i++) {
+				threads.emplace_back([this, i] { workerLoop(i); });
+			}
+		}
+
+		void stop() {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				stopping = true;
+			}
+			startCondition.notify_all();
+
+			for (auto& thread : threads) {
+				thread.join();
+			}
+			threads.clear();
+		}
+
+		uint32_t getThreadCount() const {
+			return threadCount;
+		}
+
+		// runs task(i) for every thread index i and returns once all of them have finished, rethrowing the first error
+		void run(const std::function<void(uint32_t)>& task) {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				currentTask = &task;
+				pending = threadCount - 1;
+				error = nullptr;
+				generation++;
+			}
+			startCondition.notify_all();
+
+			std::exception_ptr localError;
+			try {
+				task(0);
+			}
+			catch (...) {
+				localError = std::current_exception();
+			}
+
+			std::unique_lock<std::mutex> lock(mutex);
+			doneCondition.wait(lock, [this] { return pending == 0; });
+			currentTask = nullptr;
+
+			if (localError) {
+				std::rethrow_exception(localError);
+			}
+			if (error) {
+				std::rethrow_exception(error);
+			}
+		}
+
+	private:
+		uint32_t threadCount = 1;
+		std::vector<std::thread> threads;
+
+		std::mutex mutex;
+		std::condition_variable startCondition;
+		std::condition_variable doneCondition;
+
+		const std::function<void(uint32_t)>* currentTask = nullptr;
+		uint64_t generation = 0;
+		uint32_t pending = 0;
+		bool stopping = false;
+		std::exception_ptr error;
+
+		void workerLoop(uint32_t threadIndex) {
+			uint64_t seenGeneration = 0;
+
+			while (true) {
+				const std::function<void(uint32_t)>* task;
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					startCondition.wait(lock, [&] { return stopping || generation != seenGeneration; });
+					if (stopping) {
+						return;
+					}
+					seenGeneration = generation;
+					task = currentTask;
+				}
+
+				std::exception_ptr taskError;
+				try {
+					(*task)(threadIndex);
+				}
+				catch (...) {
+					taskError = std::current_exception();
+				}
+
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					if (taskError && !error) {
+						error = taskError;
+					}
+					pending--;
+				}
+				doneCondition.notify_one();
+			}
+		}
+};